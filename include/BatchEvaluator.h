@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Evaluation.h"
+
+// Scores many positions in one call. The material and piece-square sums run across
+// positions in SIMD lanes (AVX2 when the CPU supports it, NEON on ARM, plain C++
+// otherwise); the remaining terms are added per position. Results are identical to
+// evaluatePosition() whichever kernel runs.
+
+/**
+ * @brief Evaluates batches of positions with fixed weights.
+ * Safe to use from several threads once constructed.
+ */
+class BatchEvaluator {
+public:
+    static constexpr int LANES = 8; ///< Positions per SIMD step; batches of any size work
+
+    /**
+     * @brief Prepares the per-square tables for a set of weights.
+     * @param weights The weights to evaluate with (copied)
+     */
+    explicit BatchEvaluator(const EvalWeights &weights = defaultEvalWeights());
+
+    /**
+     * @brief Evaluates a batch of positions.
+     * @param positions The positions to evaluate
+     * @param sides The side to move in each position (TealMan or PurpleMan)
+     * @param count Number of positions
+     * @param scores Output array receiving evaluatePosition() of each position
+     */
+    void evaluate(const Bitboard *positions, const Piece *sides, int count, int *scores) const;
+
+    /**
+     * @brief Gets the name of the kernel evaluate() runs on this machine.
+     * @return "avx2", "neon" or "scalar"
+     */
+    static const char *kernelName();
+
+    /**
+     * @brief Value of each piece type on each square, material included.
+     * Purple entries are negative, so a position's material score is a plain sum.
+     */
+    struct SquareTables {
+        alignas(32) std::array<std::int32_t, NUM_SQUARES> tealMen;
+        alignas(32) std::array<std::int32_t, NUM_SQUARES> tealKings;
+        alignas(32) std::array<std::int32_t, NUM_SQUARES> purpleMen;
+        alignas(32) std::array<std::int32_t, NUM_SQUARES> purpleKings;
+    };
+
+private:
+    EvalWeights weights;  ///< Weights for the per-position terms
+    SquareTables tables;  ///< Weights folded per square for the SIMD kernels
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "GameLogic.h"
+
+// Packed 32-square board representation used by move generation and the AI.
+// Bit i of every mask is the dark square with packed index i (see squareIndex()).
+// The move functions come in two forms: templates specialized per Side for hot
+// loops that know whose turn it is, and Piece-taking wrappers that dispatch once.
+
+/**
+ * @brief A checkers position packed into three 32-bit masks (12 bytes).
+ * Kings are flagged in a shared mask and are always also present in the mask of
+ * the colour that owns them.
+ */
+struct Bitboard {
+    std::uint32_t teal = 0;    ///< Squares holding a Teal piece (men + kings)
+    std::uint32_t purple = 0;  ///< Squares holding a Purple piece (men + kings)
+    std::uint32_t kings = 0;   ///< Squares holding a king of either colour
+};
+
+/**
+ * @brief Counts the set bits in a square mask.
+ * @param mask The mask to count
+ * @return Number of squares in the mask
+ */
+inline int popCount(std::uint32_t mask) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+/**
+ * @brief Gets the lowest packed square set in a mask.
+ * @param mask A non-zero square mask
+ * @return Packed index of the lowest set bit
+ */
+inline int lowestSquare(std::uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Gets the mask with only the given packed square set.
+ * @param sq Packed square index in [0, NUM_SQUARES)
+ * @return A single-bit mask for the square
+ */
+inline constexpr std::uint32_t squareBit(int sq) {
+    return std::uint32_t{1} << sq;
+}
+
+/**
+ * @brief Gets the mask of all empty dark squares.
+ * @param bb The position to inspect
+ * @return Mask of squares holding no piece
+ */
+inline std::uint32_t emptySquares(const Bitboard &bb) {
+    return ~(bb.teal | bb.purple);
+}
+
+/**
+ * @brief Packs the board of a GameState into a Bitboard.
+ * @param state The game state to convert
+ * @return The packed position
+ */
+Bitboard toBitboard(const GameState &state);
+
+/**
+ * @brief Unpacks a Bitboard into the board of a GameState.
+ * Only the board is overwritten; the current player and selection are left untouched.
+ * @param bb The packed position
+ * @param state The game state whose board will be replaced
+ */
+void fromBitboard(const Bitboard &bb, GameState &state);
+
+/**
+ * @brief Gets the piece standing on a packed square.
+ * @param bb The position to inspect
+ * @param sq Packed square index in [0, NUM_SQUARES)
+ * @return The piece on the square, or Empty
+ */
+Piece pieceAt(const Bitboard &bb, int sq);
+
+/**
+ * @brief Applies a move on a packed board if it is legal according to checkers rules.
+ * Same rules as the GameState overload: the move must match a generated move from its source
+ * to its final square; a multi-jump is played in full.
+ * @param bb The position (will be modified if move is valid)
+ * @param from Packed source square
+ * @param to Packed target square
+ * @param wasCapture Output parameter set to true if a capture occurred, false otherwise
+ * @return true if the move was valid and applied, false if the move was invalid
+ */
+bool applyMove(Bitboard &bb, int from, int to, bool &wasCapture);
+
+/**
+ * @brief Plays a move in place on a packed board without validating it.
+ * The move must come from generateMoves() for the current position.
+ * @param bb The position to modify
+ * @param move The legal move to play
+ * @return The record needed to take the move back with unmakeMove()
+ */
+UndoRecord makeMove(Bitboard &bb, const Move &move);
+
+/**
+ * @brief Plays a move of the given side in place on a packed board without validating it.
+ * @tparam S The side that makes the move
+ * @param bb The position to modify
+ * @param move A legal move from generateMoves<S>() for the current position
+ * @return The record needed to take the move back with unmakeMove()
+ */
+template <Side S>
+UndoRecord makeMove(Bitboard &bb, const Move &move);
+
+/**
+ * @brief Takes back a move of the given side played with makeMove<S>().
+ * @tparam S The side that made the move
+ * @param bb The position to restore
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+template <Side S>
+void unmakeMove(Bitboard &bb, const Move &move, const UndoRecord &undo);
+
+/**
+ * @brief Takes back a move played with makeMove(), restoring the previous position exactly.
+ * @param bb The position to restore
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+void unmakeMove(Bitboard &bb, const Move &move, const UndoRecord &undo);
+
+/**
+ * @brief Generates all legal moves of the given side on a packed board.
+ * Colour and direction are compile-time constants, so the only branches left are on
+ * the position itself. Captures are mandatory: if any piece can jump, only complete
+ * jump sequences are generated.
+ * @tparam S The side to generate moves for
+ * @param bb The position to analyze
+ * @param moves Output list, cleared and then filled with every legal move
+ */
+template <Side S>
+void generateMoves(const Bitboard &bb, MoveList &moves);
+
+/**
+ * @brief Generates all legal moves for one player on a packed board.
+ * Captures are mandatory: if any piece can jump, only complete jump sequences are
+ * generated, each continuing until no further jump is possible or the piece is crowned.
+ * @param bb The position to analyze
+ * @param side The piece type representing the player (TealMan, PurpleMan, TealKing, or PurpleKing)
+ * @param moves Output list, cleared and then filled with every legal move
+ */
+void generateMoves(const Bitboard &bb, Piece side, MoveList &moves);
+
+/**
+ * @brief Counts the total number of pieces (men + kings) for each player using popcount.
+ * @param bb The position to analyze
+ * @param tealCount Output parameter for the number of Teal pieces
+ * @param purpleCount Output parameter for the number of Purple pieces
+ */
+void countPieces(const Bitboard &bb, int &tealCount, int &purpleCount);
+
+/**
+ * @brief Checks if the given side has at least one legal move available.
+ * Uses whole-board shifts instead of probing individual target squares.
+ * @tparam S The side to check
+ * @param bb The position to analyze
+ * @return true if the side has at least one legal move, false otherwise
+ */
+template <Side S>
+bool hasAnyMoves(const Bitboard &bb);
+
+/**
+ * @brief Counts the simple moves of the given side with whole-board shifts, ignoring
+ * captures; a cheap mobility measure for the evaluation.
+ * @tparam S The side to count for
+ * @param bb The position to analyze
+ * @return Number of (source, target) pairs of one diagonal step onto an empty square
+ */
+template <Side S>
+int countSimpleMoves(const Bitboard &bb);
+
+/**
+ * @brief Checks if the given player has at least one legal move available.
+ * Uses whole-board shifts instead of probing individual target squares.
+ * @param bb The position to analyze
+ * @param player The piece type representing the player (TealMan, PurpleMan, TealKing, or PurpleKing)
+ * @return true if the player has at least one legal move, false otherwise
+ */
+bool hasAnyMoves(const Bitboard &bb, Piece player);
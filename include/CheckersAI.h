@@ -1,36 +1,199 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iosfwd>
+#include <memory>
 #include <random>
+#include <string>
+#include <vector>
 
+#include "EndgameTablebase.h"
+#include "Evaluation.h"
 #include "GameLogic.h"
+#include "OpeningBook.h"
+#include "SearchEngine.h"
 
 /**
  * @brief Represents the difficulty level of the AI opponent.
  */
 enum class AIDifficulty {
-    Easy = 0,    ///< AI makes optimal moves 30% of the time
-    Medium = 1,  ///< AI makes optimal moves 60% of the time
-    Hard = 2     ///< AI makes optimal moves 100% of the time
+    Easy = 0,    ///< 2-ply search, plays it 30% of the time
+    Medium = 1,  ///< 4-ply search, plays it 60% of the time
+    Hard = 2     ///< Iterative deepening within a per-move time limit, always plays it
 };
 
 /**
- * @brief AI opponent for the Purple player in the checkers game.
- * Uses a simple evaluation function and makes optimal moves based on difficulty level,
- * otherwise choosing randomly from legal moves.
+ * @brief How the AI arrived at a move.
+ */
+enum class MoveSource {
+    Search,  ///< Best move of the alpha-beta search
+    Book,    ///< Taken from the opening book
+    Random   ///< Random legal move played to weaken the AI
+};
+
+/**
+ * @brief A move chosen by the AI.
+ */
+struct AIMove {
+    bool found = false;  ///< false if the side to move has no legal moves
+    Move move;           ///< The chosen move, valid when found is true
+    MoveSource source = MoveSource::Random; ///< Where the move came from
+    int score = 0;       ///< Search score from the mover's perspective, 0 unless searched
+    SearchStats stats;   ///< Work done by the search, empty unless source is Search
+    bool ponderHit = false; ///< Whether the search ran on the opponent's time, see startPondering()
+};
+
+/**
+ * @brief AI opponent for the checkers game (the Purple player in the GUI).
+ * It plays whichever side GameState::currentPlayer names, so two instances can play
+ * each other in headless self-play.
+ * Finds the best move with an alpha-beta search whose budget depends on the difficulty
+ * level, and plays it with a difficulty-dependent probability, otherwise choosing
+ * randomly from legal moves.
  */
 class CheckersAI {
 public:
     /**
      * @brief Constructs a new CheckersAI instance.
      * @param difficulty The difficulty level (Easy, Medium, or Hard)
-     * Initializes the random number generator used for move selection.
+     * @param threads Number of search threads (Lazy SMP); values below 1 are treated as 1
+     * Initializes the random number generator used for move selection and the
+     * default search budget for the difficulty.
+     */
+    CheckersAI(AIDifficulty difficulty = AIDifficulty::Medium, int threads = 1);
+
+    /**
+     * @brief Constructs a CheckersAI whose random choices repeat from run to run.
+     * Two AIs with the same seed, settings and moves make the same random choices;
+     * combine with setDeterministic() for searches that repeat as well.
+     * @param difficulty The difficulty level (Easy, Medium, or Hard)
+     * @param threads Number of search threads (Lazy SMP); values below 1 are treated as 1
+     * @param seed Seed of the random number generator used for move selection
      */
-    CheckersAI(AIDifficulty difficulty = AIDifficulty::Medium);
+    CheckersAI(AIDifficulty difficulty, int threads, std::uint32_t seed);
 
     /**
-     * @brief Chooses a move for the Purple player based on the current game state.
-     * Evaluates all legal moves and selects either the best move (based on difficulty) or
-     * a random legal move.
+     * @brief Stops any pondering search before the AI is destroyed.
+     */
+    ~CheckersAI();
+
+    /**
+     * @brief Gets the number of threads used for each search.
+     * @return The thread count, at least 1
+     */
+    int threadCount() const { return static_cast<int>(helpers.size()) + 1; }
+
+    /**
+     * @brief Overrides the search budget chosen by the difficulty level.
+     * @param limits Depth, time and node budget used for every following move
+     */
+    void setSearchLimits(const SearchLimits &limits) { this->limits = limits; }
+
+    /**
+     * @brief Gets the search budget used for each move.
+     * @return The current search limits
+     */
+    const SearchLimits &searchLimits() const { return limits; }
+
+    /**
+     * @brief Resizes the transposition table, discarding its contents.
+     * @param sizeMb Table size in megabytes
+     */
+    void setHashSizeMb(std::size_t sizeMb) { table.resize(sizeMb); }
+
+    /**
+     * @brief Discards everything learned by earlier searches, e.g. before a new game:
+     * the transposition table and the move-ordering history.
+     * Must not be called while the AI is thinking.
+     */
+    void clearHash();
+
+    /**
+     * @brief Makes every search repeat exactly for the same position and history.
+     * A deterministic AI searches on one thread whatever its thread count, runs out
+     * of a node budget instead of the clock (DETERMINISTIC_NODES_PER_MS nodes per
+     * millisecond of the time limit) and does not ponder. Its node counts and moves
+     * then depend only on the seed, the settings and the moves played so far.
+     * @param enabled Whether searches are deterministic
+     */
+    void setDeterministic(bool enabled) { deterministic = enabled; }
+
+    /**
+     * @brief Checks whether searches are deterministic, see setDeterministic().
+     * @return true if deterministic
+     */
+    bool isDeterministic() const { return deterministic; }
+
+    /**
+     * @brief Nodes a deterministic search may visit per millisecond of its time limit,
+     * about what one thread searches on a desktop machine.
+     */
+    static constexpr std::uint64_t DETERMINISTIC_NODES_PER_MS = 3000;
+
+    /**
+     * @brief Move budgets a pondering search may run for before it stops on its own,
+     * so waiting for a slow opponent does not keep the cores busy.
+     */
+    static constexpr int PONDER_TIME_FACTOR = 4;
+
+    /**
+     * @brief Memory-maps an endgame tablebase that the search probes from then on.
+     * Must not be called while the AI is thinking.
+     * @param path Path of a file written by checkers_tbgen
+     * @return true if the tablebase was loaded, false if it is missing or invalid
+     */
+    bool loadTablebase(const std::string &path) { return tablebase.open(path); }
+
+    /**
+     * @brief Gets the largest piece count the loaded tablebase covers.
+     * @return Piece count, 0 if no tablebase is loaded
+     */
+    int tablebasePieces() const { return tablebase.maxPieces(); }
+
+    /**
+     * @brief Memory-maps an opening book; book moves are played instead of searching.
+     * Must not be called while the AI is thinking.
+     * @param path Path of a book built with checkers_selfplay --book-out
+     * @return true if the book was loaded, false if it is missing or invalid
+     */
+    bool loadOpeningBook(const std::string &path) { return book.open(path); }
+
+    /**
+     * @brief Gets the number of (position, move) entries in the loaded book.
+     * @return Entry count, 0 if no book is loaded
+     */
+    std::uint64_t openingBookSize() const { return book.size(); }
+
+    /**
+     * @brief Reads evaluation weights from a configuration file, replacing the current ones.
+     * Must not be called while the AI is thinking.
+     * @param path Path of a file in the format of assets/eval.cfg
+     * @return true if the weights were loaded, false if the file is missing or invalid
+     */
+    bool loadEvalWeights(const std::string &path) { return ::loadEvalWeights(path, weights); }
+
+    /**
+     * @brief Gets the weights the search evaluates positions with.
+     * @return The current weights
+     */
+    const EvalWeights &evalWeights() const { return weights; }
+
+    /**
+     * @brief Logs every following move as one line of JSON with its search statistics.
+     * Several AIs may share one stream; their lines never interleave.
+     * Must not be called while the AI is thinking.
+     * @param log Stream to append to (not owned), or nullptr to stop logging
+     */
+    void setStatsLog(std::ostream *log) { statsLog = log; }
+
+    /**
+     * @brief Chooses a move for the side to move based on the current game state.
+     * Searches for the best move and plays it with the difficulty's probability,
+     * otherwise plays a random legal move.
      * @param state The current game state
      * @param srcRow Output parameter for the source row index of the chosen move
      * @param srcCol Output parameter for the source column index of the chosen move
@@ -42,10 +205,115 @@ public:
                     int &srcRow, int &srcCol,
                     int &dstRow, int &dstCol);
 
+    /**
+     * @brief Chooses a move for the side to move based on the current game state.
+     * @param state The current game state
+     * @param move Output parameter for the chosen move
+     * @return true if a valid move was found, false if no moves are available
+     */
+    bool chooseMove(const GameState &state, Move &move);
+
+    /**
+     * @brief Chooses a move for the side to move and reports how it was found.
+     * @param state The current game state
+     * @return The chosen move with its source, score and search statistics
+     */
+    AIMove chooseMove(const GameState &state);
+
+    /**
+     * @brief Starts choosing a move for the side to move on a background thread.
+     * Poll the returned future (e.g. wait_for with a zero timeout) once per frame so
+     * rendering continues while the AI thinks. Only one search may run at a time,
+     * and the AI must outlive the future.
+     * @param state The current game state (copied, so the caller may keep modifying it)
+     * @return A future that becomes ready with the chosen move
+     */
+    std::future<AIMove> startThinking(const GameState &state);
+
+    /**
+     * @brief Asks a running search to stop as soon as possible.
+     * The pending future still becomes ready, with the best move found so far.
+     */
+    void stopThinking() { stopSearch.store(true); }
+
+    /**
+     * @brief Starts searching on the opponent's time, right after the AI's own move.
+     * If the last search expected a reply, the position after it is searched with the
+     * AI to move; when the opponent plays that reply, the next move comes from this
+     * search and needs at most what is left of the time budget. Otherwise the
+     * opponent's position itself is searched, which fills the shared transposition
+     * table for every reply. Either way the search runs on half the helper threads
+     * until the next chooseMove() or startThinking(), stopPondering(), the last
+     * iteration the move search would run, or PONDER_TIME_FACTOR times the move's
+     * time limit, whichever comes first.
+     * Does nothing for a deterministic AI, see setDeterministic().
+     * Must not be called while the AI is thinking.
+     * @param state The position after the AI's move, with the opponent to move
+     */
+    void startPondering(const GameState &state);
+
+    /**
+     * @brief Stops a pondering search and discards its result, e.g. before a new game.
+     * Blocks until the search threads have finished.
+     */
+    void stopPondering();
+
+    /**
+     * @brief Checks whether a pondering search is running.
+     * @return true between startPondering() and the next move or stopPondering()
+     */
+    bool isPondering() const { return pondering.valid(); }
+
 private:
     std::mt19937 rng;
     AIDifficulty difficulty;  ///< The difficulty level of the AI
     float optimalMoveChance; ///< Probability of making the optimal move (0.0 to 1.0)
+    SearchLimits limits;     ///< Search budget per move
+    TranspositionTable table; ///< Results cached across moves of the game
+    EndgameTablebase tablebase; ///< Exact endgame results, empty until loadTablebase()
+    OpeningBook book;        ///< Known opening moves, empty until loadOpeningBook()
+    EvalWeights weights;     ///< Evaluation weights shared by all searches
+    SearchEngine engine;     ///< Alpha-beta search used to find the optimal move
+    std::vector<std::unique_ptr<SearchEngine>> helpers; ///< Lazy SMP helper searches
+    std::atomic<bool> stopSearch{false}; ///< Raised to stop the helpers or cancel a search
+    bool deterministic = false;  ///< Whether searches avoid threads and the clock
+    std::ostream *statsLog = nullptr; ///< Per-move JSON log, may be nullptr
+    Move predictedReply;         ///< Second move of the last search's PV
+    bool hasPrediction = false;  ///< Whether predictedReply is set
+    std::future<SearchResult> pondering;  ///< Running pondering search, valid while pondering
+    Bitboard ponderBoard;        ///< Position the pondering search is searching
+    Piece ponderSide = TealMan;  ///< Side to move in ponderBoard
+    std::chrono::steady_clock::time_point ponderStart; ///< When pondering started
+
+    /**
+     * @brief Chooses a move for the side to move: with the difficulty's probability a book
+     * move, or the search's best move if the book does not know the position; otherwise a
+     * random legal move.
+     * @param state The current game state
+     * @param pondered The pondering search of this position, or an invalid future; it is
+     *        used instead of a new search, or stopped if the move does not need one
+     * @return The chosen move
+     */
+    AIMove selectMove(const GameState &state, std::future<SearchResult> &pondered);
+
+    /**
+     * @brief Hands over the pondering search if it is of the given position, and stops
+     * it otherwise. Readies the stop flag for the search of the move.
+     * @param state The position the AI is about to move in
+     * @return The pondering search on a hit, an invalid future on a miss or when not pondering
+     */
+    std::future<SearchResult> takePonderSearch(const GameState &state);
+
+    /**
+     * @brief Runs the main search with helpers on their own threads sharing the table.
+     * @param bb The position to search
+     * @param side The side to move
+     * @param searchLimits Budget of the search
+     * @param maxHelpers Most helper threads to use besides the main search
+     * @return The main search's result, with the counters summed over all threads
+     */
+    SearchResult runSearch(const Bitboard &bb, Piece side, const SearchLimits &searchLimits,
+                           std::size_t maxHelpers);
 };
 
 
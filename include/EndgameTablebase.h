@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "Bitboard.h"
+#include "MappedFile.h"
+
+// Endgame tablebases: the exact result of every position with few pieces, built
+// offline by tools/tbgen.cpp and memory-mapped by the AI.
+//
+// Positions are grouped by material (the number of men and kings on each side).
+// Each group has its own table with one byte per position, indexed by the
+// combinatorial index of each piece type's squares and the side to move.
+
+inline constexpr int TB_MAX_PIECES = 6; // largest piece count the format can describe
+
+/**
+ * @brief The material on the board, which selects the table a position lives in.
+ */
+struct MaterialSignature {
+    int tealMen = 0;
+    int tealKings = 0;
+    int purpleMen = 0;
+    int purpleKings = 0;
+
+    /**
+     * @brief Gets the number of pieces of both sides.
+     * @return Total piece count
+     */
+    int total() const { return tealMen + tealKings + purpleMen + purpleKings; }
+
+    /**
+     * @brief Gets a dense code for the signature, used to look tables up.
+     * @return A value in [0, (TB_MAX_PIECES + 1)^4)
+     */
+    int code() const {
+        constexpr int n = TB_MAX_PIECES + 1;
+        return ((tealMen * n + tealKings) * n + purpleMen) * n + purpleKings;
+    }
+};
+
+inline constexpr int TB_SIGNATURE_CODES = (TB_MAX_PIECES + 1) * (TB_MAX_PIECES + 1) *
+                                          (TB_MAX_PIECES + 1) * (TB_MAX_PIECES + 1);
+
+/**
+ * @brief Result of a position for the side to move.
+ */
+enum class TBOutcome { Draw, Win, Loss };
+
+/**
+ * @brief A decoded tablebase entry.
+ */
+struct TBResult {
+    TBOutcome outcome = TBOutcome::Draw;
+    int distance = 0;  ///< Plies until the losing side has no move, with best play
+};
+
+inline constexpr int TB_MAX_DISTANCE = 254; ///< Longest distance a table byte can hold
+
+/**
+ * @brief Packs a result into one byte: 0 is a draw, otherwise distance + 1.
+ * An even distance is a loss for the side to move and an odd one a win.
+ * @param distance Plies until the game ends, at most TB_MAX_DISTANCE
+ * @return The stored byte
+ */
+inline constexpr std::uint8_t encodeTablebaseValue(int distance) {
+    return static_cast<std::uint8_t>(distance + 1);
+}
+
+/**
+ * @brief Unpacks a stored byte.
+ * @param value Byte read from a table
+ * @return The result for the side to move
+ */
+inline TBResult decodeTablebaseValue(std::uint8_t value) {
+    TBResult result;
+    if (value == 0) {
+        return result;
+    }
+    result.distance = value - 1;
+    result.outcome = (result.distance % 2 == 0) ? TBOutcome::Loss : TBOutcome::Win;
+    return result;
+}
+
+/**
+ * @brief Header at the start of a tablebase file.
+ */
+struct TablebaseFileHeader {
+    char magic[8];             ///< "CHKRSTB" followed by a zero byte
+    std::uint32_t rulesVersion; ///< RULES_VERSION the tables were built with
+    std::uint32_t maxPieces;   ///< Every material with up to this many pieces is present
+    std::uint32_t tableCount;  ///< Number of TablebaseTableInfo records after the header
+    std::uint32_t reserved;
+};
+
+/**
+ * @brief Directory record locating one material's table in the file.
+ */
+struct TablebaseTableInfo {
+    std::uint8_t tealMen, tealKings, purpleMen, purpleKings;
+    std::uint32_t reserved;
+    std::uint64_t offset;  ///< Byte offset of the table from the start of the file
+    std::uint64_t size;    ///< Number of entries (bytes) in the table
+};
+
+static_assert(sizeof(TablebaseFileHeader) == 24, "tablebase header layout changed");
+static_assert(sizeof(TablebaseTableInfo) == 24, "tablebase directory layout changed");
+
+inline constexpr char TB_MAGIC[8] = {'C', 'H', 'K', 'R', 'S', 'T', 'B', '\0'};
+
+/**
+ * @brief Counts the material of a position.
+ * @param bb The position to inspect
+ * @return The signature of the position
+ */
+MaterialSignature materialOf(const Bitboard &bb);
+
+/**
+ * @brief Gets the number of entries in a material's table, for both sides to move.
+ * Entries whose pieces would share a square exist but are never used.
+ * @param sig The material
+ * @return Number of entries
+ */
+std::uint64_t tablebaseSize(const MaterialSignature &sig);
+
+/**
+ * @brief Computes where a position is stored in its material's table.
+ * @param bb The position, whose material must be sig
+ * @param side The side to move (TealMan or PurpleMan)
+ * @param sig The material of bb
+ * @return Index in [0, tablebaseSize(sig))
+ */
+std::uint64_t tablebaseIndex(const Bitboard &bb, Piece side, const MaterialSignature &sig);
+
+/**
+ * @brief Rebuilds the position stored at an index, the inverse of tablebaseIndex().
+ * @param sig The material of the table
+ * @param index Index in [0, tablebaseSize(sig))
+ * @param bb Output parameter for the position
+ * @param side Output parameter for the side to move
+ * @return false if the index names an impossible position (two pieces on one square)
+ */
+bool tablebasePosition(const MaterialSignature &sig, std::uint64_t index, Bitboard &bb, Piece &side);
+
+/**
+ * @brief A memory-mapped tablebase file. Probing reads single bytes straight from the
+ * mapping, so only the pages that the search touches are ever loaded.
+ * Safe to probe from several threads once open.
+ */
+class EndgameTablebase {
+public:
+    /**
+     * @brief Maps a tablebase file, closing any previously opened one.
+     * @param path Path of the file written by checkers_tbgen
+     * @return true if the file was mapped and is valid for the current rules
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Checks if a tablebase is available.
+     * @return true if open() succeeded
+     */
+    bool isOpen() const { return file.isOpen(); }
+
+    /**
+     * @brief Gets the largest piece count covered by the open file.
+     * @return Piece count, 0 if no file is open
+     */
+    int maxPieces() const { return pieces; }
+
+    /**
+     * @brief Looks a position up.
+     * @param bb The position to look up
+     * @param side The side to move (TealMan or PurpleMan)
+     * @param result Output parameter filled on success
+     * @return true if the position is covered by the tablebase, false otherwise
+     */
+    bool probe(const Bitboard &bb, Piece side, TBResult &result) const;
+
+private:
+    struct Table {
+        const std::uint8_t *data = nullptr; ///< Entries inside the mapping, nullptr if absent
+        std::uint64_t size = 0;             ///< Number of entries
+    };
+
+    MappedFile file;                            ///< The mapped tablebase file
+    int pieces = 0;                             ///< Largest piece count covered
+    std::array<Table, TB_SIGNATURE_CODES> tables{}; ///< Tables by MaterialSignature::code()
+};
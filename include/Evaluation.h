@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "Bitboard.h"
+
+// Static evaluation of quiet positions for the search.
+//
+// The score is a weighted sum of material, piece-square bonuses, mobility and a
+// tempo bonus for the side to move. Material and piece-square terms only change
+// where pieces move, so the search keeps their sum up to date move by move with
+// materialMoveDelta() instead of rescanning the board at every leaf.
+
+/**
+ * @brief Weights of every evaluation term, in hundredths of a man.
+ * Piece-square tables are indexed by packed square as seen by Teal; Purple uses the
+ * board turned half a turn, so both sides share one table.
+ */
+struct EvalWeights {
+    int manValue = 100;   ///< Value of a man
+    int kingValue = 140;  ///< Value of a king
+    int mobility = 3;     ///< Bonus per simple move available, compared with the opponent
+    int tempo = 5;        ///< Bonus for being the side to move
+
+    /// Bonus of a man on each square: advancement toward the crown row and back-rank defence.
+    std::array<int, NUM_SQUARES> manSquares{
+          0,   0,   0,   0,  // row 0: men are crowned here
+         30,  32,  32,  32,  // row 1
+         22,  22,  22,  16,  // row 2
+         10,  15,  15,  12,  // row 3
+          8,  10,  10,   4,  // row 4
+          0,   4,   4,   2,  // row 5
+          2,   0,   0,   0,  // row 6
+          6,  12,   6,  12,  // row 7: back rank guards the crown squares
+    };
+
+    /// Bonus of a king on each square: kings belong in the centre, away from the edges.
+    std::array<int, NUM_SQUARES> kingSquares{
+          0,   0,   0,   0,
+          0,   4,   4,   2,
+          2,   8,   8,   0,
+          0,  10,  10,   4,
+          4,  10,  10,   0,
+          0,   8,   8,   2,
+          2,   4,   4,   0,
+          0,   0,   0,   0,
+    };
+};
+
+/**
+ * @brief Gets the weights used when no configuration file has been loaded.
+ * @return The built-in weights
+ */
+const EvalWeights &defaultEvalWeights();
+
+/**
+ * @brief Reads weights from a configuration file.
+ * The file holds one "name value..." line per term (see assets/eval.cfg); '#' starts a
+ * comment and terms that are not listed keep their current value.
+ * @param path File to read
+ * @param weights Weights to update; left unchanged if the file is invalid
+ * @return true if the file was read, false if it is missing or malformed
+ */
+bool loadEvalWeights(const std::string &path, EvalWeights &weights);
+
+/**
+ * @brief Writes weights in the format loadEvalWeights() reads.
+ * @param path File to write
+ * @param weights The weights to write
+ * @return true if the file was written, false on an I/O error
+ */
+bool saveEvalWeights(const std::string &path, const EvalWeights &weights);
+
+/**
+ * @brief Computes the material and piece-square score of a position from scratch.
+ * @param bb The position to score
+ * @param weights The weights to use
+ * @return Score from Teal's perspective
+ */
+int materialScore(const Bitboard &bb, const EvalWeights &weights);
+
+/**
+ * @brief Computes how a move changes materialScore().
+ * Add the result after makeMove(); subtract it to undo the move.
+ * @param after The position after the move was made
+ * @param move The move that was made
+ * @param undo The record makeMove() returned
+ * @param weights The weights to use
+ * @return Change of the score from Teal's perspective
+ */
+int materialMoveDelta(const Bitboard &after, const Move &move, const UndoRecord &undo,
+                      const EvalWeights &weights);
+
+/**
+ * @brief Completes an evaluation from an up-to-date material score.
+ * Adds mobility and tempo and turns the score to the side to move's perspective.
+ * @param bb The position to evaluate
+ * @param side The side to move (TealMan or PurpleMan)
+ * @param material materialScore() of bb
+ * @param weights The weights to use
+ * @return Score from the side to move's perspective
+ */
+int evaluateWithMaterial(const Bitboard &bb, Piece side, int material, const EvalWeights &weights);
+
+/**
+ * @brief Evaluates a position from the perspective of the given side, from scratch.
+ * @param bb The position to evaluate
+ * @param side The piece type of the side to evaluate for (TealMan or PurpleMan)
+ * @param weights The weights to use
+ * @return Positive value if the side is ahead, negative if it is behind
+ */
+int evaluatePosition(const Bitboard &bb, Piece side, const EvalWeights &weights = defaultEvalWeights());
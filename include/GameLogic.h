@@ -1,10 +1,20 @@
 #pragma once
 
 #include <array>
+#include <cassert>
+#include <cstdint>
 
 // Core game constants and data structures shared by the game, UI, and AI.
 
 inline constexpr int BOARD_SIZE = 8;   // standard 8x8 board
+inline constexpr int NUM_SQUARES = 32; // playable (dark) squares on the board
+inline constexpr int MAX_MOVES = 64;   // upper bound on legal moves in any position
+inline constexpr int MAX_JUMPS = 12;   // longest capture sequence: every opposing piece
+
+// Stored in generated data files (tablebase, opening book) so files built for
+// other rules are rejected. Bump whenever move generation changes.
+// Version 2: captures are mandatory and chain into multi-jumps.
+inline constexpr std::uint32_t RULES_VERSION = 2;
 
 enum Piece {
     Empty,
@@ -14,6 +24,11 @@ enum Piece {
     PurpleKing
 };
 
+/**
+ * @brief A player, for code specialized per side at compile time (see generateMoves<S>()).
+ */
+enum class Side { Teal, Purple };
+
 struct GameState {
     std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> board{};
     Piece currentPlayer = TealMan;
@@ -21,6 +36,56 @@ struct GameState {
     int selectedCol = -1;
 };
 
+/**
+ * @brief A legal move expressed in packed square indices (see squareIndex()).
+ * A capture is the whole jump sequence: every square the piece lands on in order,
+ * ending with to, and the mask of every piece it removes.
+ */
+struct Move {
+    std::uint8_t from = 0;       ///< Packed source square
+    std::uint8_t to = 0;         ///< Packed target square
+    std::uint8_t jumps = 0;      ///< Number of jumps, 0 for a simple move
+    std::array<std::uint8_t, MAX_JUMPS> path; ///< Landing square of each jump; only the first jumps are set
+    std::uint32_t captured = 0;  ///< Mask of captured squares, 0 for a simple move
+
+    /**
+     * @brief Checks if the move captures at least one opponent piece.
+     * @return true if the move is a capture, false otherwise
+     */
+    bool isCapture() const { return captured != 0; }
+};
+
+/**
+ * @brief Everything makeMove() changes beyond the moving piece, so unmakeMove() can restore it.
+ */
+struct UndoRecord {
+    std::uint32_t capturedKings = 0; ///< Squares of Move::captured that held a king
+    bool promoted = false;           ///< Whether the moving man was crowned by the move
+};
+
+/**
+ * @brief Fixed-capacity list of moves stored inline, so generating moves never allocates.
+ */
+struct MoveList {
+    std::array<Move, MAX_MOVES> moves;
+    int count = 0;
+
+    void clear() { count = 0; }
+    void push(const Move &m) {
+        assert(count < MAX_MOVES);
+        moves[count++] = m;
+    }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move &operator[](int i) { return moves[i]; }
+    const Move &operator[](int i) const { return moves[i]; }
+    Move *begin() { return moves.data(); }
+    Move *end() { return moves.data() + count; }
+    const Move *begin() const { return moves.data(); }
+    const Move *end() const { return moves.data() + count; }
+};
+
 /**
  * @brief Checks if the given row and column coordinates are within the board bounds.
  * @param r Row index (0-based)
@@ -37,6 +102,36 @@ bool inBounds(int r, int c);
  */
 bool isDarkSquare(int r, int c);
 
+/**
+ * @brief Maps a dark square to its packed square index.
+ * Dark squares are numbered 0-31 row by row from the top (row 0), four per row.
+ * @param r Row index (0-based)
+ * @param c Column index (0-based), must be a dark square in row r
+ * @return The packed square index in [0, NUM_SQUARES)
+ */
+inline constexpr int squareIndex(int r, int c) {
+    return r * (BOARD_SIZE / 2) + c / 2;
+}
+
+/**
+ * @brief Gets the board row of a packed square index.
+ * @param sq Packed square index in [0, NUM_SQUARES)
+ * @return Row index (0-based)
+ */
+inline constexpr int squareRow(int sq) {
+    return sq / (BOARD_SIZE / 2);
+}
+
+/**
+ * @brief Gets the board column of a packed square index.
+ * Even rows have their dark squares on odd columns and vice versa.
+ * @param sq Packed square index in [0, NUM_SQUARES)
+ * @return Column index (0-based)
+ */
+inline constexpr int squareCol(int sq) {
+    return 2 * (sq % (BOARD_SIZE / 2)) + (squareRow(sq) % 2 == 0 ? 1 : 0);
+}
+
 /**
  * @brief Initializes the game board with starting positions for both players.
  * Places Teal pieces on the top 3 rows and Purple pieces on the bottom 3 rows,
@@ -45,18 +140,69 @@ bool isDarkSquare(int r, int c);
  */
 void initBoard(GameState &state);
 
+/**
+ * @brief How the squares clicked so far match the legal moves of a piece, see applyMovePath().
+ */
+enum class PathMatch {
+    Illegal,    ///< No legal move lands on these squares
+    Partial,    ///< The squares begin a jump sequence; more landing squares are needed
+    Ambiguous,  ///< Several jump sequences end on the last square; click each landing square instead
+    Played      ///< Exactly one move matched and was played
+};
+
+/**
+ * @brief Applies the legal move of a piece that lands on the given squares.
+ * The squares are the ones the piece lands on in order, as the player clicks them.
+ * The last square may also be the final square of a jump sequence whose earlier
+ * landings are not given, as long as only one sequence ends there and none passes
+ * through it; two sequences with the same source and final square capture
+ * different pieces and need every landing.
+ * Captures are mandatory, so a simple move is rejected while any capture is available.
+ * @param state The current game state (will be modified if a move is played)
+ * @param from Packed source square
+ * @param landings Packed landing squares in order (see Move::path)
+ * @param count Number of landing squares, at least 1
+ * @param wasCapture Output parameter set to true if a capture was played, false otherwise
+ * @param played If not nullptr, receives the move that was played
+ * @return How the squares match; the state only changes on PathMatch::Played
+ */
+PathMatch applyMovePath(GameState &state, int from, const int *landings, int count, bool &wasCapture,
+                        Move *played = nullptr);
+
 /**
  * @brief Applies a move if it is legal according to checkers rules.
- * Validates the move, performs captures if applicable, and handles kinging.
+ * The move is given by its source and final square; a multi-jump is played in full.
+ * Captures are mandatory, so a simple move is rejected while any capture is available.
+ * If several jump sequences share both squares the move is ambiguous and rejected;
+ * applyMovePath() tells them apart by their landing squares.
  * @param state The current game state (will be modified if move is valid)
  * @param sr Source row index (0-based)
  * @param sc Source column index (0-based)
  * @param tr Target row index (0-based)
  * @param tc Target column index (0-based)
  * @param wasCapture Output parameter set to true if a capture occurred, false otherwise
+ * @param played If not nullptr, receives the move that was played
  * @return true if the move was valid and applied, false if the move was invalid
  */
-bool applyMove(GameState &state, int sr, int sc, int tr, int tc, bool &wasCapture);
+bool applyMove(GameState &state, int sr, int sc, int tr, int tc, bool &wasCapture,
+               Move *played = nullptr);
+
+/**
+ * @brief Plays a move in place without validating it.
+ * The move must come from generateMoves() for the current position.
+ * @param state The game state to modify
+ * @param move The legal move to play
+ * @return The record needed to take the move back with unmakeMove()
+ */
+UndoRecord makeMove(GameState &state, const Move &move);
+
+/**
+ * @brief Takes back a move played with makeMove(), restoring the previous board exactly.
+ * @param state The game state to restore
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+void unmakeMove(GameState &state, const Move &move, const UndoRecord &undo);
 
 /**
  * @brief Counts the total number of pieces (men + kings) for each player.
@@ -66,6 +212,15 @@ bool applyMove(GameState &state, int sr, int sc, int tr, int tc, bool &wasCaptur
  */
 void countPieces(const GameState &state, int &tealCount, int &purpleCount);
 
+/**
+ * @brief Generates all legal moves for one player without copying the board.
+ * Captures are mandatory and are generated as complete jump sequences.
+ * @param state The current game state
+ * @param side The piece type representing the player (TealMan, PurpleMan, TealKing, or PurpleKing)
+ * @param moves Output list, cleared and then filled with every legal move
+ */
+void generateMoves(const GameState &state, Piece side, MoveList &moves);
+
 /**
  * @brief Checks if the given player has at least one legal move available.
  * @param state The current game state
@@ -92,4 +247,20 @@ inline bool isPurplePiece(Piece p) {
     return p == PurpleMan || p == PurpleKing;
 }
 
+/**
+ * @brief Gets the side a piece belongs to.
+ * @param p A non-empty piece
+ * @return Side::Teal for TealMan or TealKing, Side::Purple otherwise
+ */
+inline constexpr Side sideOf(Piece p) {
+    return (p == TealMan || p == TealKing) ? Side::Teal : Side::Purple;
+}
 
+/**
+ * @brief Gets the side that moves after the given side.
+ * @param s A side
+ * @return The opposing side
+ */
+inline constexpr Side opposite(Side s) {
+    return s == Side::Teal ? Side::Purple : Side::Teal;
+}
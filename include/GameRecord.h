@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Bitboard.h"
+#include "MappedFile.h"
+
+// Compact game records: the moves of a game from the starting position, one or a
+// few bytes each, appended to a binary file game by game so millions of self-play
+// games stay small and can be scanned quickly.
+//
+// A move is stored as its source square and the direction of each step, which is
+// enough to rebuild it without the position:
+//   simple move  0dd sssss            one byte: direction d, source square s
+//   capture      1dd sssss  nn xxxxxx first jump's direction, then continuation
+//                                     bytes holding n (0-2) further directions in
+//                                     xxxxxx, two bits each; n == 3 means three
+//                                     directions and another continuation byte
+// so single jumps and multi-jumps of up to three jumps take two bytes.
+// Directions are 0 = up-left, 1 = up-right, 2 = down-left, 3 = down-right, where
+// up is towards row 0.
+//
+// A file is a GameFileHeader followed by games, each a 5-byte little-endian game
+// header (outcome, ply count, byte count) and its move bytes. Games are only ever
+// appended; a reader stops at a truncated last game.
+
+/**
+ * @brief How a recorded game ended.
+ */
+enum class GameOutcome : std::uint8_t {
+    Unfinished = 0, ///< Abandoned or still being played
+    TealWin = 1,    ///< Purple had no pieces or no legal moves
+    Draw = 2,       ///< Drawn, e.g. adjudicated after a ply limit
+    PurpleWin = 3   ///< Teal had no pieces or no legal moves
+};
+
+/**
+ * @brief Header at the start of a game record file.
+ */
+struct GameFileHeader {
+    char magic[8];              ///< "CHKRGAME"
+    std::uint32_t rulesVersion; ///< RULES_VERSION the games were played under
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(GameFileHeader) == 16, "game file header layout changed");
+
+inline constexpr char GAME_MAGIC[8] = {'C', 'H', 'K', 'R', 'G', 'A', 'M', 'E'};
+
+/**
+ * @brief Longest encoding of a move: a full 12-jump capture.
+ */
+inline constexpr int MAX_ENCODED_MOVE = 2 + (MAX_JUMPS - 1) / 3;
+
+/**
+ * @brief Encodes a move in the compact record format.
+ * @param move A move from generateMoves()
+ * @param out Buffer of at least MAX_ENCODED_MOVE bytes
+ * @return Number of bytes written
+ */
+int encodeMove(const Move &move, std::uint8_t *out);
+
+/**
+ * @brief Decodes one move of the compact record format.
+ * The move is rebuilt from its squares alone; replaying it is only valid if it is
+ * legal in the position it is played in.
+ * @param in The encoded bytes
+ * @param available Number of bytes readable at in
+ * @param move Output parameter for the move
+ * @return Number of bytes read, 0 if the bytes are not a valid move
+ */
+int decodeMove(const std::uint8_t *in, std::size_t available, Move &move);
+
+/**
+ * @brief The moves of one game from the starting position, in compact form.
+ */
+class GameRecord {
+public:
+    /**
+     * @brief Forgets all moves and the outcome, e.g. before a new game.
+     */
+    void clear();
+
+    /**
+     * @brief Appends the next move of the game.
+     * @param move The move played, from generateMoves() for the current position
+     */
+    void append(const Move &move);
+
+    /**
+     * @brief Gets the number of moves recorded.
+     * @return Ply count
+     */
+    int plyCount() const { return plies; }
+
+    /**
+     * @brief Gets how the game ended.
+     * @return The outcome, Unfinished unless setOutcome() was called
+     */
+    GameOutcome outcome() const { return result; }
+
+    /**
+     * @brief Records how the game ended.
+     * @param outcome The outcome
+     */
+    void setOutcome(GameOutcome outcome) { result = outcome; }
+
+    /**
+     * @brief Gets the encoded moves.
+     * @return The move bytes in playing order
+     */
+    const std::vector<std::uint8_t> &bytes() const { return data; }
+
+    /**
+     * @brief Replaces the record with encoded moves, e.g. ones read from a file.
+     * @param bytes The move bytes
+     * @param plyCount Number of moves they hold
+     * @param outcome How the game ended
+     */
+    void assign(std::vector<std::uint8_t> bytes, int plyCount, GameOutcome outcome);
+
+    /**
+     * @brief Decodes every move.
+     * @param moves Output parameter receiving the moves in playing order
+     * @return true if all bytes decoded into exactly plyCount() moves
+     */
+    bool decode(std::vector<Move> &moves) const;
+
+private:
+    std::vector<std::uint8_t> data;  ///< Encoded moves
+    int plies = 0;                   ///< Moves in data
+    GameOutcome result = GameOutcome::Unfinished;
+};
+
+/**
+ * @brief Appends games to a record file.
+ * Not thread-safe; writers on several threads must share one under a lock.
+ */
+class GameRecordWriter {
+public:
+    /**
+     * @brief Opens a file for appending, writing its header if it is new or empty.
+     * @param path The file to append to
+     * @return true if the file is open, false if it cannot be written or is not a
+     * record file for the current rules
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Appends a game.
+     * @param record The game to write
+     * @return true if it was written, false on an I/O error
+     */
+    bool write(const GameRecord &record);
+
+    /**
+     * @brief Checks if a file is open.
+     * @return true if open() succeeded
+     */
+    bool isOpen() const { return out.is_open(); }
+
+private:
+    std::ofstream out;
+};
+
+/**
+ * @brief Reads the games of a record file in order from a memory mapping.
+ */
+class GameRecordReader {
+public:
+    /**
+     * @brief Maps a record file, closing any previously opened one.
+     * @param path Path of a file written by GameRecordWriter
+     * @return true if the file was mapped and is valid for the current rules
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Reads the next game.
+     * @param record Output parameter for the game
+     * @return true if a game was read, false at the end of the file
+     */
+    bool next(GameRecord &record);
+
+    /**
+     * @brief Starts reading again from the first game.
+     */
+    void rewind() { offset = sizeof(GameFileHeader); }
+
+private:
+    MappedFile file;
+    std::size_t offset = 0;  ///< Start of the next game
+};
+
+/**
+ * @brief Steps through a recorded game, rebuilding any ply with make/unmake.
+ */
+class GameReplay {
+public:
+    /**
+     * @brief Decodes a game and checks every move is legal; the replay starts at ply 0.
+     * @param record The game to replay
+     * @return true if the game is valid, false if a move is corrupt or illegal
+     */
+    bool load(const GameRecord &record);
+
+    /**
+     * @brief Gets the number of moves in the game.
+     * @return Ply count
+     */
+    int plyCount() const { return static_cast<int>(moves.size()); }
+
+    /**
+     * @brief Gets the ply the replay is at.
+     * @return Number of moves played so far
+     */
+    int ply() const { return current; }
+
+    /**
+     * @brief Moves to a ply by playing or taking back moves from the current one.
+     * @param ply Target ply, clamped to [0, plyCount()]
+     */
+    void seek(int ply);
+
+    /**
+     * @brief Gets the position at the current ply.
+     * @return The position
+     */
+    const Bitboard &position() const { return bb; }
+
+    /**
+     * @brief Gets the side to move at the current ply.
+     * @return TealMan or PurpleMan
+     */
+    Piece sideToMove() const { return current % 2 == 0 ? TealMan : PurpleMan; }
+
+    /**
+     * @brief Gets a move of the game.
+     * @param ply Index of the move, in [0, plyCount())
+     * @return The move
+     */
+    const Move &move(int ply) const { return moves[ply]; }
+
+private:
+    std::vector<Move> moves;
+    std::vector<UndoRecord> undos;  ///< For each played move
+    Bitboard bb;
+    int current = 0;
+};
+
+/**
+ * @brief Formats a game as PDN text with its tags and numbered moves.
+ * Teal is Black and moves first; "1-0" is a Teal win.
+ * @param record The game
+ * @param event Value of the Event tag
+ * @param round Value of the Round tag, e.g. the game's number
+ * @return The PDN game, ending with a blank line
+ */
+std::string toPdn(const GameRecord &record, const std::string &event, const std::string &round);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ * Pages are read from disk on first access, so opening a large file is cheap
+ * and only the parts that are actually touched use memory.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Unmaps the file if one is open.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Maps a file, unmapping any previously opened one.
+     * @param path Path of the file to map
+     * @return true if the file was mapped, false if it is missing, empty or cannot be mapped
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmaps the file. Pointers obtained from data() become invalid.
+     */
+    void close();
+
+    /**
+     * @brief Checks if a file is mapped.
+     * @return true if open() succeeded and close() has not been called since
+     */
+    bool isOpen() const { return bytes != nullptr; }
+
+    /**
+     * @brief Gets the mapped contents.
+     * @return Pointer to the first byte of the file, or nullptr if none is open
+     */
+    const unsigned char *data() const { return bytes; }
+
+    /**
+     * @brief Gets the size of the mapped file.
+     * @return File size in bytes, 0 if none is open
+     */
+    std::size_t size() const { return length; }
+
+private:
+    const unsigned char *bytes = nullptr; ///< Start of the mapping
+    std::size_t length = 0;               ///< Length of the mapping in bytes
+#if defined(_WIN32)
+    void *fileHandle = nullptr;           ///< HANDLE of the open file
+    void *mappingHandle = nullptr;        ///< HANDLE of the file mapping object
+#endif
+};
+
+/**
+ * @brief Maps one of the game's data files and checks its header.
+ * The header must start with an 8-byte magic followed by the RULES_VERSION the
+ * file was written for. Problems are reported on stderr, prefixed with the
+ * description, and leave the file closed; a stale file gets the rebuild hint.
+ * @param file Mapping to open, closing any previously opened file
+ * @param path Path of the file to map
+ * @param magic Expected first 8 bytes of the file
+ * @param headerSize Size of the whole header in bytes
+ * @param description Kind of file for messages, e.g. "Opening book"
+ * @param rebuildHint How to replace a file written for other rules, e.g.
+ * "rebuild it with checkers_selfplay --book-out"
+ * @return true if the file was mapped, is at least headerSize bytes long and was
+ * written with magic for the current rules
+ */
+bool openDataFile(MappedFile &file, const std::string &path, const char (&magic)[8], std::size_t headerSize,
+                  const char *description, const char *rebuildHint);
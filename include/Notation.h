@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+
+#include "Bitboard.h"
+
+// Conversion between packed positions and standard PDN notation.
+// PDN numbers the dark squares 1-32 starting from the first mover's back rank.
+// Teal moves first, so Teal is PDN "Black" (squares 1-12 at the start) and
+// Purple is PDN "White" (squares 21-32).
+
+/**
+ * @brief FEN of the standard starting position, Teal (Black) to move.
+ */
+inline constexpr const char *START_FEN = "B:W21,22,23,24,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,11,12";
+
+/**
+ * @brief Converts a packed square index to its PDN square number.
+ * @param sq Packed square index in [0, NUM_SQUARES)
+ * @return PDN square number in [1, 32]
+ */
+inline constexpr int squareToPdn(int sq) {
+    return NUM_SQUARES - sq;
+}
+
+/**
+ * @brief Converts a PDN square number to its packed square index.
+ * @param n PDN square number in [1, 32]
+ * @return Packed square index in [0, NUM_SQUARES)
+ */
+inline constexpr int pdnToSquare(int n) {
+    return NUM_SQUARES - n;
+}
+
+/**
+ * @brief Parses a PDN FEN string such as "B:W18,24,K27:B12,16".
+ * Square lists may contain ranges ("1-12") and a 'K' prefix marks a king.
+ * @param fen The FEN string to parse
+ * @param bb Output parameter for the position
+ * @param side Output parameter for the side to move (TealMan or PurpleMan)
+ * @return true if the string was a valid FEN, false otherwise
+ */
+bool parseFen(const std::string &fen, Bitboard &bb, Piece &side);
+
+/**
+ * @brief Formats a position as a PDN FEN string.
+ * @param bb The position to format
+ * @param side The side to move (TealMan or PurpleMan)
+ * @return The FEN string, with squares in ascending order
+ */
+std::string toFen(const Bitboard &bb, Piece side);
+
+/**
+ * @brief Formats a move in PDN style, e.g. "11-15", "15x24", or "1x10x19" for a multi-jump.
+ * @param move The move to format
+ * @return The move text
+ */
+std::string moveToString(const Move &move);
+
+/**
+ * @brief Finds the legal move written in PDN style, e.g. "11-15", "15x24" or "1x10x19".
+ * A multi-jump may be written with every landing square or with its end squares
+ * alone ("1x19"), as long as only one jump sequence joins them.
+ * @param text The move text
+ * @param legal The legal moves of the position, from generateMoves()
+ * @param move Output parameter for the matching move
+ * @return true if the text names exactly one legal move, false otherwise
+ */
+bool parseMove(const std::string &text, const MoveList &legal, Move &move);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bitboard.h"
+#include "MappedFile.h"
+
+// Opening book: known good moves for positions near the start of the game, built
+// offline from self-play results and memory-mapped by the AI.
+//
+// The file is a header followed by BookEntry records sorted by position key, one
+// record per (position, move), so all moves of a position are adjacent and found
+// with a binary search.
+
+/**
+ * @brief One book move for one position.
+ */
+struct BookEntry {
+    std::uint64_t key = 0;     ///< Zobrist key of the position, side to move included
+    std::uint8_t from = 0;     ///< Packed source square of the move
+    std::uint8_t to = 0;       ///< Packed target square of the move
+    std::uint16_t weight = 0;  ///< Relative chance of playing the move
+    std::uint32_t captured = 0; ///< Captured squares, which tell jump sequences apart
+};
+
+/**
+ * @brief Header at the start of a book file.
+ */
+struct BookFileHeader {
+    char magic[8];              ///< "CHKRBOOK"
+    std::uint32_t rulesVersion; ///< RULES_VERSION the book was built with
+    std::uint32_t reserved;
+    std::uint64_t entryCount;   ///< Number of BookEntry records after the header
+};
+
+static_assert(sizeof(BookEntry) == 16, "book entry layout changed");
+static_assert(sizeof(BookFileHeader) == 24, "book header layout changed");
+
+inline constexpr char BOOK_MAGIC[8] = {'C', 'H', 'K', 'R', 'B', 'O', 'O', 'K'};
+
+/**
+ * @brief Sorts book entries and writes them as a book file.
+ * @param path Output file
+ * @param entries The entries to write; sorted in place
+ * @return true if the file was written, false on an I/O error
+ */
+bool writeOpeningBook(const std::string &path, std::vector<BookEntry> &entries);
+
+/**
+ * @brief A memory-mapped opening book.
+ * Safe to probe from several threads once open.
+ */
+class OpeningBook {
+public:
+    /**
+     * @brief Maps a book file, closing any previously opened one.
+     * @param path Path of a file written by writeOpeningBook()
+     * @return true if the file was mapped and is valid for the current rules
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Checks if a book is available.
+     * @return true if open() succeeded
+     */
+    bool isOpen() const { return file.isOpen(); }
+
+    /**
+     * @brief Gets the number of (position, move) entries.
+     * @return Entry count, 0 if no book is open
+     */
+    std::uint64_t size() const { return count; }
+
+    /**
+     * @brief Finds the book entries of a position.
+     * @param key Zobrist key of the position
+     * @param first Output parameter for the first matching entry
+     * @return Number of entries for the position, 0 if it is not in the book
+     */
+    int find(std::uint64_t key, const BookEntry *&first) const;
+
+    /**
+     * @brief Picks a book move for a position, at random in proportion to the weights.
+     * Book moves that are not legal here (a hash collision) are ignored.
+     * @param bb The position
+     * @param side The side to move (TealMan or PurpleMan)
+     * @param legal The legal moves of the position
+     * @param rng Random source for the weighted choice
+     * @param move Output parameter for the chosen move
+     * @return true if the book had a move for the position, false otherwise
+     */
+    bool chooseMove(const Bitboard &bb, Piece side, const MoveList &legal, std::mt19937 &rng, Move &move) const;
+
+private:
+    MappedFile file;                   ///< The mapped book file
+    const BookEntry *entries = nullptr; ///< Sorted entries inside the mapping
+    std::uint64_t count = 0;           ///< Number of entries
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+// Scoped timers and counters for finding slow stages, e.g. frame hitches.
+//
+// Instrument code with the macros below. They compile to nothing unless the build
+// defines CHECKERS_PROFILE (make PROFILE=1), so instrumentation stays in place at no
+// cost. A profiling build records every timed scope and counter sample with its
+// thread, and writeChromeTrace() saves them as Chrome trace-event JSON for
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// Names must be string literals: only the pointer is stored.
+
+#if defined(CHECKERS_PROFILE)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+/// Times the rest of the enclosing scope under the given name.
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+/// Records a sample of a counter, drawn as a graph in the trace viewer.
+#define PROFILE_COUNTER(name, value) profileCounter(name, static_cast<double>(value))
+/// Marks the end of a frame so frame times can be graphed.
+#define PROFILE_FRAME() profileFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+
+/**
+ * @brief Records the time between construction and destruction as one trace event.
+ * Use through PROFILE_SCOPE rather than directly.
+ */
+class ProfileScope {
+public:
+    /**
+     * @brief Starts timing.
+     * @param name Event name, a string literal
+     */
+    explicit ProfileScope(const char *name) : name(name), start(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Stops timing and records the event.
+     */
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Records a sample of a counter.
+ * @param name Counter name, a string literal
+ * @param value Current value
+ */
+void profileCounter(const char *name, double value);
+
+/**
+ * @brief Marks the end of a frame, recording the time since the previous mark.
+ */
+void profileFrame();
+
+/**
+ * @brief Number of frame times kept for the on-screen graph.
+ */
+inline constexpr int PROFILE_FRAME_HISTORY = 120;
+
+/**
+ * @brief Copies the most recent frame times, oldest first.
+ * @param out Array receiving up to PROFILE_FRAME_HISTORY times in milliseconds
+ * @return Number of times copied
+ */
+int recentFrameTimes(float *out);
+
+/**
+ * @brief Writes every recorded event as Chrome trace-event JSON.
+ * @param path File to write
+ * @return true if the file was written, false on an I/O error
+ */
+bool writeChromeTrace(const std::string &path);
@@ -1,7 +1,15 @@
 #pragma once
 
 #include <raylib.h>
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
 #include "GameLogic.h"
+#include "SearchEngine.h"
 
 /**
  * @brief Represents the result of a game.
@@ -20,11 +28,26 @@ class Renderer {
 public:
     /**
      * @brief Constructs a new Renderer and initializes Raylib.
-     * Creates the main game window and sets up 3D camera.
+     * Creates the main game window and sets up 3D camera, and starts building the
+     * meshes and picking maps on a worker thread; until finishLoading() returns true
+     * only the 2D screens (such as the difficulty menu) can be drawn.
      * @return true if initialization succeeded, false otherwise
      */
     bool initialize();
 
+    /**
+     * @brief Uploads the assets built in the background to the GPU once they are ready.
+     * Call once per frame while showing 2D screens; it does not wait.
+     * @return true once the assets are loaded and renderGame() may be called
+     */
+    bool finishLoading();
+
+    /**
+     * @brief Waits for the background asset build and uploads the result.
+     * Must be called before the first renderGame().
+     */
+    void waitForAssets();
+
     /**
      * @brief Destructor that cleans up all Raylib resources.
      */
@@ -32,8 +55,9 @@ public:
 
     /**
      * @brief Renders the game board, pieces, and UI elements in 3D using Raylib.
-     * Draws a 3D checkered board, 3D cylindrical pieces with crown models for kings,
-     * the sidebar with piece counts, and highlights the currently selected piece.
+     * Draws the 3D checkered board, cylindrical pieces and king crowns from meshes
+     * uploaded at initialization (a handful of draw calls), the sidebar with piece
+     * counts, and highlights the currently selected piece.
      * @param state The current game state to render
      */
     void renderGame(const GameState &state);
@@ -56,14 +80,40 @@ public:
 
     /**
      * @brief Converts screen coordinates to 3D board coordinates.
-     * Used for mouse picking in the 3D scene.
+     * Used for mouse picking in the 3D scene. A piece under the pointer gives its own
+     * square, even where its raised top or side covers the square behind it; elsewhere
+     * a pixel-to-square map of the board, built whenever the camera moves, gives the
+     * square. Both match what is drawn.
+     * @param state The pieces on the board
      * @param mouseX Screen X coordinate
      * @param mouseY Screen Y coordinate
      * @param outRow Output parameter for board row (-1 if invalid)
      * @param outCol Output parameter for board column (-1 if invalid)
      * @param isTealActive Whether Teal is the active player (for camera positioning)
      */
-    void screenToBoard(int mouseX, int mouseY, int &outRow, int &outCol, bool isTealActive) const;
+    void screenToBoard(const GameState &state, int mouseX, int mouseY, int &outRow, int &outCol,
+                       bool isTealActive) const;
+
+    /**
+     * @brief Sets the square under the pointer, highlighted in the next frames.
+     * @param row Board row, or -1 for none
+     * @param col Board column, or -1 for none
+     */
+    void setHoveredSquare(int row, int col) {
+        hoverRow = row;
+        hoverCol = col;
+    }
+
+    /**
+     * @brief Sets the landing squares of the jump being entered, marked in the next frames.
+     * @param landings Packed squares clicked so far after selecting the piece
+     * @param ambiguous Whether to ask the player to click every landing square, because
+     *        the last click ended several jump sequences
+     */
+    void setMovePath(const std::vector<int> &landings, bool ambiguous) {
+        pathSquares = landings;
+        pathAmbiguous = ambiguous;
+    }
 
     /**
      * @brief Gets the mouse position.
@@ -84,6 +134,13 @@ public:
      */
     int renderDifficultyMenu(int selectedDifficulty);
 
+    /**
+     * @brief Shows the statistics of the AI's last search in the sidebar.
+     * @param stats Statistics to show (not owned, must outlive their display), or
+     *        nullptr to hide the panel
+     */
+    void setSearchStats(const SearchStats *stats) { searchStats = stats; }
+
 private:
     static constexpr float CELL_SIZE = 1.0f;      ///< Size of each board cell in 3D units
     static constexpr float PIECE_HEIGHT = 0.3f;   ///< Height of pieces
@@ -91,14 +148,43 @@ private:
     static constexpr int SIDEBAR_WIDTH = 200;     ///< Width of the sidebar in pixels
     static constexpr int WINDOW_WIDTH = 800;      ///< Window width in pixels
     static constexpr int WINDOW_HEIGHT = 800;     ///< Window height in pixels
+    static constexpr int FRAME_GRAPH_HEIGHT = 70; ///< Height of the frame-time graph with its caption
+#if defined(CHECKERS_PROFILE)
+    static constexpr int STATS_BOTTOM = WINDOW_HEIGHT - FRAME_GRAPH_HEIGHT - 20; ///< Search stats end here
+#else
+    static constexpr int STATS_BOTTOM = WINDOW_HEIGHT; ///< Search stats end here
+#endif
 
     Camera3D camera;  ///< 3D camera for viewing the board
     Font font;        ///< Font for text rendering
+    const SearchStats *searchStats = nullptr; ///< Shown in the sidebar when not nullptr
+
+    // GPU resources created once by loadMeshes()
+    bool meshesLoaded = false;  ///< Whether the meshes and materials below exist
+    bool instancing = false;    ///< Whether the instancing shader compiled
+    Mesh boardMesh{};           ///< All 64 squares merged into one vertex-colored mesh
+    std::array<Model, 4> pieceModels{}; ///< Prebuilt model of each piece type, index Piece - 1
+    Material meshMaterial{};    ///< Default shader, for the board and non-instanced draws
+    Material instancedMaterial{}; ///< Instancing shader for pieces, with their outlines
 
     // Camera parameters
     float cameraDistance = 12.0f;  ///< Distance from board center
     float cameraAngle = 60.0f;     ///< Angle from horizontal (degrees)
 
+    /**
+     * @brief The square under each pixel of the 3D viewport for one camera position.
+     */
+    struct PickingMap {
+        Vector3 cameraPosition{};          ///< Camera position the map was built for
+        std::vector<std::int8_t> squares;  ///< row * BOARD_SIZE + col per pixel, -1 off the board
+    };
+    std::array<PickingMap, 2> pickingMaps; ///< For Teal's [0] and Purple's [1] camera
+
+    int hoverRow = -1;  ///< Square under the pointer, -1 if none
+    int hoverCol = -1;
+    std::vector<int> pathSquares;  ///< Landing squares of the jump being entered
+    bool pathAmbiguous = false;    ///< Whether the sidebar asks for every landing square
+
     /**
      * @brief Updates camera position based on active player.
      * @param isTealActive Whether Teal is the active player
@@ -106,32 +192,84 @@ private:
     void updateCamera(bool isTealActive);
 
     /**
-     * @brief Renders a single board square in 3D.
-     * @param row Board row (0-7)
-     * @param col Board column (0-7)
-     * @param isDark Whether this is a dark square
-     * @param isSelected Whether this square is currently selected
+     * @brief Gets the camera placed behind a player.
+     * @param isTealActive Whether the camera is Teal's
+     * @return The camera, with the current distance and angle
+     */
+    Camera3D cameraFor(bool isTealActive) const;
+
+    /**
+     * @brief Rebuilds a picking map by projecting every square's top face through a camera.
+     * Touches no GPU state, so it may run on any thread.
+     * @param map The map to fill
+     * @param view The camera the board is drawn with
+     */
+    static void buildPickingMap(PickingMap &map, const Camera3D &view);
+
+    /**
+     * @brief Projects a point of the scene to a pixel of the board viewport.
+     * @param point Point in world space
+     * @param view The camera the board is drawn with
+     * @return Pixel position in the board viewport
+     */
+    static Vector2 projectToBoardView(const Vector3 &point, const Camera3D &view);
+
+    /**
+     * @brief Finds the piece drawn at a pixel of the board viewport.
+     * @param state The pieces on the board
+     * @param view The camera the board is drawn with
+     * @param px Pixel x in the board viewport
+     * @param py Pixel y in the board viewport
+     * @return row * BOARD_SIZE + col of the piece's square, -1 if no piece is there
+     */
+    static int pieceAtPixel(const GameState &state, const Camera3D &view, float px, float py);
+
+    /// Mesh geometry and picking maps built on the worker thread, defined in Renderer.cpp.
+    struct PreparedAssets;
+    std::future<std::unique_ptr<PreparedAssets>> assetBuild; ///< Valid until finishLoading() takes it
+
+    /**
+     * @brief Uploads the board, piece and crown meshes to the GPU and loads the shaders.
+     * Called once from finishLoading(); nothing is rebuilt per frame.
+     * @param assets Geometry built in the background
+     */
+    void loadMeshes(const PreparedAssets &assets);
+
+    /**
+     * @brief Draws one mesh at many positions.
+     * Uses a single instanced draw call when the instancing shader is available,
+     * otherwise one DrawMesh call per instance.
+     * @param mesh The mesh to draw
+     * @param color Color multiplied with the mesh's vertex colors
+     * @param transforms Model matrix of each instance
+     * @param count Number of instances
+     */
+    void drawInstances(const Mesh &mesh, Color color, const Matrix *transforms, int count);
+
+    /**
+     * @brief Renders the pieces of the given state with instanced draws.
+     * @param state The game state whose pieces to draw
      */
-    void renderBoardSquare(int row, int col, bool isDark, bool isSelected);
+    void renderPieces(const GameState &state);
 
     /**
-     * @brief Renders a 3D cylindrical piece.
-     * @param x X position in 3D space
-     * @param z Z position in 3D space
-     * @param isTeal Whether this is a teal piece (false = purple)
-     * @param isKing Whether this is a king piece
+     * @brief Renders the AI's search statistics below the piece counts.
+     * @param x Left edge of the panel
+     * @param y Top edge of the panel
      */
-    void renderPiece(float x, float z, bool isTeal, bool isKing);
+    void renderSearchStats(int x, int y);
 
     /**
-     * @brief Renders a 3D crown on top of a king piece.
-     * @param x X position in 3D space
-     * @param z Z position in 3D space
+     * @brief Renders a graph of recent frame times (profiling builds only).
+     * Bars are green within a 60 Hz frame, yellow within two and red beyond.
+     * @param x Left edge of the graph
+     * @param y Top edge of the graph, including its caption
+     * @param width Width of the graph in pixels
      */
-    void renderCrown(float x, float z);
+    void renderFrameGraph(int x, int y, int width);
 
     /**
-     * @brief Renders the 2D UI overlay (sidebar with piece counts).
+     * @brief Renders the 2D UI overlay (sidebar with piece counts and, if set, search statistics).
      * @param tealCount Number of teal pieces
      * @param purpleCount Number of purple pieces
      */
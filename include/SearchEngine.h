@@ -0,0 +1,268 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Bitboard.h"
+#include "EndgameTablebase.h"
+#include "Evaluation.h"
+#include "TranspositionTable.h"
+
+inline constexpr int MAX_PLY = 64;          // deepest ply the search will ever reach
+inline constexpr int WIN_SCORE = 10000;     // score of a won position at the root
+// Scores at or beyond this are forced wins or losses. A tablebase result adds its
+// distance, which can far exceed MAX_PLY, to the ply it is found at.
+inline constexpr int MATE_BOUND = WIN_SCORE - MAX_PLY - TB_MAX_DISTANCE;
+inline constexpr int INFINITE_SCORE = 32000; // bound wider than any real score
+
+/**
+ * @brief Budget for a single search. A zero time or node limit means "unlimited";
+ * the search always stops after maxDepth plies.
+ */
+struct SearchLimits {
+    int maxDepth = MAX_PLY;        ///< Deepest iteration to run (plies)
+    int timeLimitMs = 0;           ///< Wall-clock budget per move in milliseconds, 0 = unlimited
+    std::uint64_t nodeLimit = 0;   ///< Node budget per move, 0 = unlimited
+};
+
+/**
+ * @brief Work done by one completed iteration of iterative deepening.
+ */
+struct IterationStats {
+    int depth = 0;            ///< Depth searched (plies)
+    int score = 0;            ///< Score of the iteration's best move
+    std::uint64_t nodes = 0;  ///< Nodes visited during this iteration
+    double timeMs = 0;        ///< Time spent on this iteration
+};
+
+/**
+ * @brief Statistics about the work a search did, used to size time budgets and to
+ * spot search regressions.
+ */
+struct SearchStats {
+    std::uint64_t nodes = 0;          ///< Positions visited, including quiescence
+    std::uint64_t tbHits = 0;         ///< Positions resolved by the endgame tablebase
+    std::uint64_t ttProbes = 0;       ///< Transposition table lookups
+    std::uint64_t ttHits = 0;         ///< Lookups that found the position
+    std::uint64_t expandedNodes = 0;  ///< Full-width nodes whose moves were searched
+    std::uint64_t betaCutoffs = 0;    ///< Expanded nodes that failed high
+    std::uint64_t firstMoveCutoffs = 0; ///< Cutoffs caused by the first move searched
+    int depth = 0;                    ///< Deepest fully completed iteration
+    double timeMs = 0;                ///< Wall-clock time of the search
+    std::vector<IterationStats> iterations; ///< One entry per completed iteration
+    std::vector<Move> pv;             ///< Principal variation, starting with the best move
+
+    /**
+     * @brief Gets the search speed.
+     * @return Nodes per second, 0 if no time was measured
+     */
+    double nps() const { return timeMs > 0 ? nodes * 1000.0 / timeMs : 0.0; }
+
+    /**
+     * @brief Gets the share of transposition table lookups that hit.
+     * @return Hit rate between 0 and 1
+     */
+    double ttHitRate() const { return ttProbes ? static_cast<double>(ttHits) / ttProbes : 0.0; }
+
+    /**
+     * @brief Gets the share of expanded nodes that ended in a beta cutoff.
+     * @return Cutoff ratio between 0 and 1
+     */
+    double cutoffRatio() const {
+        return expandedNodes ? static_cast<double>(betaCutoffs) / expandedNodes : 0.0;
+    }
+
+    /**
+     * @brief Gets the share of beta cutoffs caused by the first move searched, a measure
+     * of how well moves are ordered.
+     * @return First-move cutoff rate between 0 and 1
+     */
+    double firstMoveCutoffRate() const {
+        return betaCutoffs ? static_cast<double>(firstMoveCutoffs) / betaCutoffs : 0.0;
+    }
+
+    /**
+     * @brief Adds the counters of another search of the same position, e.g. a Lazy SMP helper.
+     * Depth, time, iterations and PV stay those of this search.
+     * @param other The search to add
+     */
+    void addCounters(const SearchStats &other) {
+        nodes += other.nodes;
+        tbHits += other.tbHits;
+        ttProbes += other.ttProbes;
+        ttHits += other.ttHits;
+        expandedNodes += other.expandedNodes;
+        betaCutoffs += other.betaCutoffs;
+        firstMoveCutoffs += other.firstMoveCutoffs;
+    }
+};
+
+/**
+ * @brief Outcome of a search: the move to play and what the search learned about it.
+ */
+struct SearchResult {
+    bool found = false;       ///< false if the side to move has no legal moves
+    Move bestMove;            ///< Best move from the deepest search that produced one
+    int score = 0;            ///< Score of bestMove from the side to move's perspective
+    SearchStats stats;        ///< Work done by the search
+};
+
+/**
+ * @brief Negamax alpha-beta search with iterative deepening.
+ * Each iteration searches one ply deeper than the last until the depth, time or node
+ * budget runs out; the best move of the deepest usable iteration is returned.
+ * The search runs on a single mutable position whose Zobrist key and material score
+ * are updated incrementally as moves are made and unmade.
+ *
+ * Moves are searched best-first so alpha-beta cuts off as early as possible: the
+ * transposition table move, then captures by the material they win, then the two
+ * killer moves of the ply (quiet moves that caused a cutoff in a sibling node), then
+ * the remaining quiet moves by their history score. Killers are cleared at the start
+ * of each search; history carries over from move to move and is halved whenever an
+ * entry grows large, so old cutoffs fade as the game moves on.
+ */
+class SearchEngine {
+public:
+    /**
+     * @brief Sets the transposition table used to cache results between nodes and searches.
+     * @param table The table to use (not owned), or nullptr to search without one
+     */
+    void setTranspositionTable(TranspositionTable *table) { tt = table; }
+
+    /**
+     * @brief Sets a flag that aborts the search as soon as it becomes true.
+     * Lets another thread stop this search, e.g. when the main Lazy SMP thread finishes.
+     * @param flag The flag to poll (not owned), or nullptr
+     */
+    void setStopFlag(const std::atomic<bool> *flag) { stopFlag = flag; }
+
+    /**
+     * @brief Sets the endgame tablebase probed for positions with few pieces.
+     * @param table The tablebase to probe (not owned), or nullptr to search without one
+     */
+    void setTablebase(const EndgameTablebase *table) { tablebase = table; }
+
+    /**
+     * @brief Sets the weights used to evaluate positions.
+     * @param evalWeights The weights to use (not owned), or nullptr for the built-in ones
+     */
+    void setEvalWeights(const EvalWeights *evalWeights) {
+        weights = evalWeights ? evalWeights : &defaultEvalWeights();
+    }
+
+    /**
+     * @brief Forgets the history scores, so the next search orders moves like a new engine.
+     */
+    void clearHistory() { history = {}; }
+
+    /**
+     * @brief Searches the given position for the best move of the side to move.
+     * @param root The position to search
+     * @param side The piece type of the side to move (TealMan or PurpleMan)
+     * @param limits Depth, time and node budget for this search
+     * @param threadIndex 0 for the main search; Lazy SMP helpers pass 1, 2, ... so they
+     *        start at staggered depths and root move orders and fill the shared table
+     *        with different parts of the tree
+     * @return The best move found and search statistics
+     */
+    SearchResult search(const Bitboard &root, Piece side, const SearchLimits &limits,
+                        int threadIndex = 0);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    TranspositionTable *tt = nullptr; ///< Shared result cache, may be nullptr
+    const std::atomic<bool> *stopFlag = nullptr; ///< External abort request, may be nullptr
+    const EndgameTablebase *tablebase = nullptr; ///< Exact endgame results, may be nullptr
+    const EvalWeights *weights = &defaultEvalWeights(); ///< Evaluation weights, never nullptr
+    Bitboard board;                  ///< Position being searched, updated in place
+    std::uint64_t key = 0;           ///< Zobrist key of board with the side to move
+    int material = 0;                ///< materialScore() of board, from Teal's perspective
+    SearchLimits limits;             ///< Budget of the running search
+    Clock::time_point startTime;     ///< When the running search started
+    SearchStats stats;               ///< Counters of the running search
+    bool stopped = false;            ///< Set once the budget is exhausted
+
+    /// Quiet move that cut off at a ply, as packed from/to squares; 0 = none (from == to never happens).
+    std::array<std::array<std::uint16_t, 2>, MAX_PLY> killers{};
+    /// Cutoff-weighted count of quiet moves per side, source and target square.
+    std::array<std::array<std::array<int, NUM_SQUARES>, NUM_SQUARES>, 2> history{};
+
+    /**
+     * @brief Gives each move an ordering score, higher to be searched first.
+     * @param moves The generated moves
+     * @param side The side to move
+     * @param ply Distance from the root, selects the killer moves
+     * @param hashMove Transposition table entry with a best move, or nullptr
+     * @param scores Output array, one score per move
+     */
+    void scoreMoves(const MoveList &moves, Piece side, int ply, const TTEntry *hashMove, int *scores) const;
+
+    /**
+     * @brief Records a quiet move that caused a beta cutoff as a killer and in the history.
+     * @param move The move
+     * @param side The side that played it
+     * @param depth Remaining depth of the node, deeper cutoffs weigh more
+     * @param ply Distance from the root
+     */
+    void recordCutoff(const Move &move, Piece side, int depth, int ply);
+
+    /**
+     * @brief Plays a move on the search position and updates its key and material score.
+     * @param move The legal move to play
+     * @return The record needed by unmakeMove()
+     */
+    UndoRecord makeMove(const Move &move);
+
+    /**
+     * @brief Takes back a move played with makeMove(), restoring the position, key and score.
+     * @param move The move that was played
+     * @param undo The record returned when the move was played
+     */
+    void unmakeMove(const Move &move, const UndoRecord &undo);
+
+    /**
+     * @brief Alpha-beta search of one subtree of the search position.
+     * @param side The side to move
+     * @param depth Remaining depth in plies
+     * @param ply Distance from the root
+     * @param alpha Lower bound of the search window
+     * @param beta Upper bound of the search window
+     * @return Score from the side to move's perspective
+     */
+    int negamax(Piece side, int depth, int ply, int alpha, int beta);
+
+    /**
+     * @brief Search of forced captures at the horizon so leaves are not scored mid-exchange.
+     * @param side The side to move
+     * @param ply Distance from the root
+     * @param alpha Lower bound of the search window
+     * @param beta Upper bound of the search window
+     * @return Score from the side to move's perspective
+     */
+    int quiescence(Piece side, int ply, int alpha, int beta);
+
+    /**
+     * @brief Counts a node and sets stopped once the time or node budget is used up
+     * or the stop flag is raised.
+     */
+    void visitNode();
+
+    /**
+     * @brief Gets the time spent on the running search.
+     * @return Elapsed milliseconds since the search started
+     */
+    std::int64_t elapsedMs() const;
+
+    /**
+     * @brief Follows best moves stored in the transposition table from the root.
+     * @param side The side to move at the root
+     * @param bestMove The move chosen at the root
+     * @param maxLength Longest variation to return
+     * @return The principal variation, starting with bestMove
+     */
+    std::vector<Move> principalVariation(Piece side, const Move &bestMove, int maxLength);
+};
@@ -2,17 +2,33 @@
 
 #include <raylib.h>
 
+#include <array>
+#include <future>
+#include <string>
+#include <vector>
+
 /**
- * @brief Manages sound effects for the checkers game.
+ * @brief Manages sound effects and background music for the checkers game.
  * Handles loading and playing sound files using Raylib audio.
  * Supports a demo.mp3 override that will be used for all sound effects if present.
+ *
+ * The audio device is started and every effect clip is decoded once, on a background
+ * thread so the window is not held up, into a small pool of voices that share the
+ * decoded samples; overlapping plays of the same clip each get their own voice
+ * instead of cutting each other off. Only the optional music track (music.mp3) is
+ * streamed through a Music buffer instead of being decoded up front; it loops, and
+ * needs update() to be called every frame while it plays.
  */
 class SoundManager {
 public:
+    static constexpr int VOICES = 4;  ///< Simultaneous plays of one effect clip
+
     /**
-     * @brief Constructs a new SoundManager and initializes the audio system.
-     * Attempts to initialize Raylib audio and load sound effect files.
-     * If demo.mp3 exists, it will be used for all sound effects.
+     * @brief Constructs a new SoundManager and starts the audio system in the background.
+     * Initializes Raylib audio and decodes the sound effect files on a worker thread;
+     * sounds played before they are ready are skipped.
+     * If demo.mp3 exists, it will be used for all sound effects. If music.mp3 exists,
+     * it is streamed in a loop once loading finishes.
      */
     SoundManager();
 
@@ -21,44 +37,94 @@ public:
      */
     ~SoundManager();
 
+    SoundManager(const SoundManager &) = delete;
+    SoundManager &operator=(const SoundManager &) = delete;
+
+    /**
+     * @brief Finishes loading once the background decode is done and refills the
+     * music stream's buffers. Call once per frame.
+     */
+    void update();
+
+    /**
+     * @brief Checks whether update() still has work to do.
+     * @return true while sounds are loading or the music is playing
+     */
+    bool needsUpdate() const;
+
+    /**
+     * @brief Checks whether the background loading has been taken over by update().
+     * @return true once the sounds are ready, or loading failed for good
+     */
+    bool isLoaded() const { return !loading.valid(); }
+
     /**
      * @brief Plays the move sound effect.
-     * Stops any currently playing sound before playing the new one.
+     * Uses a free voice, or restarts the oldest one if all are busy.
      */
     void playMove();
 
     /**
      * @brief Plays the capture sound effect.
-     * Stops any currently playing sound before playing the new one.
+     * Uses a free voice, or restarts the oldest one if all are busy.
      */
     void playCapture();
 
     /**
      * @brief Plays the victory sound effect.
-     * Stops any currently playing sound before playing the new one.
+     * Uses a free voice, or restarts the oldest one if all are busy.
      */
     void playWin();
 
     /**
      * @brief Plays the defeat sound effect.
-     * Stops any currently playing sound before playing the new one.
+     * Uses a free voice, or restarts the oldest one if all are busy.
      */
     void playLose();
 
     /**
      * @brief Checks if the sound system was successfully initialized.
-     * @return true if audio initialization succeeded, false otherwise
+     * @return true if audio initialization succeeded, false otherwise or while loading
      */
     bool isInitialized() const { return initialized; }
 
 private:
+    enum Effect { MoveEffect, CaptureEffect, WinEffect, LoseEffect, EFFECT_COUNT };
+
+    /**
+     * @brief One sound file: a pool of voices for an effect, or a stream for the music.
+     */
+    struct Clip {
+        std::string path;
+        bool streamed = false;          ///< The music track, played through music instead of voices
+        std::array<Sound, VOICES> voices{}; ///< voices[0] owns the samples, the rest alias it
+        int voiceCount = 0;             ///< Voices loaded, 0 until decoding finishes
+        int nextVoice = 0;              ///< Voice to reuse when all are busy
+        Music music{};                  ///< The stream, when streamed
+    };
+
+    /**
+     * @brief A clip decoded by the background loader.
+     */
+    struct DecodedClip {
+        int clip;  ///< Index into clips
+        Wave wave;
+    };
+
+    /**
+     * @brief What the background loader hands to the main thread.
+     */
+    struct LoadResult {
+        bool audioReady = false;           ///< Whether the audio device started
+        std::vector<DecodedClip> decoded;  ///< Clips decoded, empty if audio failed
+    };
+
     bool initialized;
-    Sound demo;      // optional shared demo sound
-    Sound move;
-    Sound capture;
-    Sound win;
-    Sound lose;
+    std::vector<Clip> clips;                      ///< demo.mp3 or one clip per effect, then the music
+    std::array<int, EFFECT_COUNT> effectClip{};   ///< Clip of each effect, -1 if missing
+    std::future<LoadResult> loading;              ///< Pending load, valid until update() takes it
 
     void loadSounds();
-    void playSound(Sound sound);
+    void finishLoading(LoadResult result);
+    void playEffect(Effect effect);
 };
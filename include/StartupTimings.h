@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <iosfwd>
+
+// Wall-clock timings of the startup stages, e.g. window creation, audio device
+// start-up and asset loading, for tracking time-to-first-frame. Stages may run on
+// any thread; they are reported in the order they started, relative to launch.
+//
+// Unlike the profiler's timers these are always compiled in: the handful of stages
+// cost nothing measurable. Names must be string literals: only the pointer is stored.
+
+/**
+ * @brief Records the time between construction and destruction as one startup stage.
+ */
+class StartupStage {
+public:
+    /**
+     * @brief Starts timing a stage.
+     * @param name Stage name, a string literal
+     */
+    explicit StartupStage(const char *name) : name(name), start(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Stops timing and records the stage.
+     */
+    ~StartupStage();
+
+    StartupStage(const StartupStage &) = delete;
+    StartupStage &operator=(const StartupStage &) = delete;
+
+private:
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Records a moment of startup, such as the first frame, as a stage of no duration.
+ * @param name Milestone name, a string literal
+ */
+void markStartup(const char *name);
+
+/**
+ * @brief Writes every recorded stage with its start, duration and thread.
+ * @param out Stream to write to
+ */
+void printStartupTimings(std::ostream &out);
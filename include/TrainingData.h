@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "Bitboard.h"
+#include "MappedFile.h"
+
+// Labelled positions for tuning the evaluation: each searched position of a
+// self-play game with the search's score and the game's final result.
+//
+// Positions are written straight from the game runner into shard files, one per
+// worker thread so writers never wait on each other. A shard is a header followed
+// by fixed-size TrainingPosition records, so it can be memory-mapped and read in
+// place; the record count follows from the file size.
+
+/**
+ * @brief One labelled position.
+ */
+struct TrainingPosition {
+    Bitboard bb;              ///< The position
+    std::int16_t score = 0;   ///< Search score from the side to move's perspective, clamped
+    std::uint8_t side = 0;    ///< Side to move: 0 for Teal, 1 for Purple
+    std::uint8_t result = 0;  ///< Game result for the side to move: 0 loss, 1 draw, 2 win
+};
+
+/**
+ * @brief Header at the start of a training shard.
+ */
+struct TrainingFileHeader {
+    char magic[8];              ///< "CHKRTRAN"
+    std::uint32_t rulesVersion; ///< RULES_VERSION the games were played under
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(TrainingPosition) == 16, "training position layout changed");
+static_assert(sizeof(TrainingFileHeader) == 16, "training header layout changed");
+
+inline constexpr char TRAINING_MAGIC[8] = {'C', 'H', 'K', 'R', 'T', 'R', 'A', 'N'};
+
+/**
+ * @brief Gets the file name of one shard of a data set.
+ * @param prefix Path prefix of the data set, e.g. "data/run1"
+ * @param index Shard number
+ * @return The shard's path, e.g. "data/run1-003.train"
+ */
+std::string trainingShardPath(const std::string &prefix, int index);
+
+/**
+ * @brief Writes labelled positions to one shard file.
+ * Not thread-safe; give each thread its own shard.
+ */
+class TrainingShardWriter {
+public:
+    /**
+     * @brief Creates a shard, replacing any existing file.
+     * @param path The file to write
+     * @return true if the file is open, false if it cannot be created
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Appends a position.
+     * @param position The labelled position
+     */
+    void add(const TrainingPosition &position);
+
+    /**
+     * @brief Flushes and closes the file.
+     * @return true if every position was written, false on an I/O error
+     */
+    bool close();
+
+    /**
+     * @brief Gets the number of positions written so far.
+     * @return Position count
+     */
+    std::uint64_t size() const { return count; }
+
+private:
+    std::ofstream out;
+    std::uint64_t count = 0;
+};
+
+/**
+ * @brief A memory-mapped training shard.
+ */
+class TrainingShard {
+public:
+    /**
+     * @brief Maps a shard, closing any previously opened one.
+     * @param path Path of a file written by TrainingShardWriter
+     * @return true if the file was mapped and is valid for the current rules
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Gets the positions of the shard, valid while it stays open.
+     * @return Pointer to the first position
+     */
+    const TrainingPosition *positions() const {
+        return reinterpret_cast<const TrainingPosition *>(file.data() + sizeof(TrainingFileHeader));
+    }
+
+    /**
+     * @brief Gets the number of positions.
+     * @return Position count, 0 if no shard is open
+     */
+    std::size_t size() const { return count; }
+
+private:
+    MappedFile file;
+    std::size_t count = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "GameLogic.h"
+
+/**
+ * @brief How a stored score relates to the true score of the position.
+ */
+enum class Bound : std::uint8_t {
+    None = 0,   ///< Slot holds no usable score
+    Exact = 1,  ///< Score is exact
+    Lower = 2,  ///< True score is at least the stored score (fail high)
+    Upper = 3   ///< True score is at most the stored score (fail low)
+};
+
+/**
+ * @brief A decoded transposition table entry.
+ */
+struct TTEntry {
+    int depth = 0;              ///< Remaining depth the score was searched to
+    Bound bound = Bound::None;  ///< How score bounds the true value
+    int score = 0;              ///< Stored score (mate scores are relative to the node)
+    bool hasMove = false;       ///< Whether bestFrom/bestTo hold a move
+    std::uint8_t bestFrom = 0;  ///< Packed source square of the best move
+    std::uint8_t bestTo = 0;    ///< Packed target square of the best move
+};
+
+/**
+ * @brief Fixed-size hash table of search results shared lock-free between search threads.
+ *
+ * Each slot holds the entry data and the key XORed with that data in two atomic words.
+ * A slot torn by a concurrent write fails the key check on probe and is treated as a
+ * miss, so readers and writers never need a lock.
+ */
+class TranspositionTable {
+public:
+    /**
+     * @brief Constructs a table using about the given amount of memory.
+     * @param sizeMb Table size in megabytes (rounded down to a power-of-two slot count)
+     */
+    explicit TranspositionTable(std::size_t sizeMb = 16);
+
+    /**
+     * @brief Reallocates the table with a new size, discarding all entries.
+     * Must not be called while a search is using the table.
+     * @param sizeMb Table size in megabytes
+     */
+    void resize(std::size_t sizeMb);
+
+    /**
+     * @brief Discards all entries.
+     * Must not be called while a search is using the table.
+     */
+    void clear();
+
+    /**
+     * @brief Marks the start of a new search so entries from older searches are replaced first.
+     */
+    void newSearch();
+
+    /**
+     * @brief Looks up a position.
+     * @param key Zobrist key of the position
+     * @param entry Output parameter filled on a hit
+     * @return true if the table holds an entry for the key, false otherwise
+     */
+    bool probe(std::uint64_t key, TTEntry &entry) const;
+
+    /**
+     * @brief Stores a search result, replacing the slot if the new result is more useful.
+     * @param key Zobrist key of the position
+     * @param depth Remaining depth the score was searched to
+     * @param bound How score bounds the true value
+     * @param score Score relative to the node
+     * @param bestMove Best move found, or nullptr if none
+     */
+    void store(std::uint64_t key, int depth, Bound bound, int score, const Move *bestMove);
+
+    /**
+     * @brief Gets the configured table size.
+     * @return Table size in megabytes
+     */
+    std::size_t sizeMb() const { return sizeInMb; }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check{0};  ///< key ^ data
+        std::atomic<std::uint64_t> data{0};   ///< Packed entry
+    };
+
+    std::unique_ptr<Slot[]> slots;  ///< Power-of-two array of slots
+    std::size_t mask = 0;           ///< Slot count - 1, used to index by key
+    std::size_t sizeInMb = 0;       ///< Size requested at construction or resize
+    std::uint8_t generation = 0;    ///< Age of the current search, stored with each entry
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Bitboard.h"
+
+// Zobrist hashing of packed positions. Keys are generated at compile time from a
+// fixed seed, so hashes are identical across runs, builds and machines.
+
+/**
+ * @brief Random keys for every (piece, square) pair plus the side to move.
+ * Keys for Empty are zero so an absent piece never changes a hash.
+ */
+struct ZobristKeys {
+    std::array<std::array<std::uint64_t, NUM_SQUARES>, 5> pieces{};
+    std::uint64_t purpleToMove = 0;
+};
+
+/**
+ * @brief Builds the key table with the splitmix64 generator.
+ * @return The filled key table
+ */
+constexpr ZobristKeys buildZobristKeys() {
+    ZobristKeys keys{};
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&state]() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+    for (int p = TealMan; p <= PurpleKing; ++p) {
+        for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+            keys.pieces[p][sq] = next();
+        }
+    }
+    keys.purpleToMove = next();
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = buildZobristKeys();
+
+/**
+ * @brief Computes the hash of a position from scratch.
+ * @param bb The position to hash
+ * @param side The side to move (TealMan or PurpleMan)
+ * @return The Zobrist key of the position
+ */
+inline std::uint64_t zobristKey(const Bitboard &bb, Piece side) {
+    std::uint64_t key = isPurplePiece(side) ? ZOBRIST.purpleToMove : 0;
+    for (std::uint32_t pieces = bb.teal | bb.purple; pieces; pieces &= pieces - 1) {
+        int sq = lowestSquare(pieces);
+        key ^= ZOBRIST.pieces[pieceAt(bb, sq)][sq];
+    }
+    return key;
+}
+
+/**
+ * @brief Computes how a move changes the hash, including the change of side to move.
+ * XOR the result into the key after makeMove(); XOR it again to undo the move.
+ * @param after The position after the move was made
+ * @param move The move that was made
+ * @param undo The record makeMove() returned
+ * @return The value to XOR into the key
+ */
+inline std::uint64_t zobristMoveDelta(const Bitboard &after, const Move &move, const UndoRecord &undo) {
+    Piece moved = pieceAt(after, move.to);
+    Piece before = moved;
+    if (undo.promoted) {
+        before = isTealPiece(moved) ? TealMan : PurpleMan;
+    }
+
+    std::uint64_t delta = ZOBRIST.pieces[before][move.from] ^ ZOBRIST.pieces[moved][move.to] ^
+                          ZOBRIST.purpleToMove;
+    bool tealMoved = isTealPiece(moved);
+    for (std::uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        int sq = lowestSquare(captured);
+        bool king = (undo.capturedKings & squareBit(sq)) != 0;
+        Piece victim = tealMoved ? (king ? PurpleKing : PurpleMan) : (king ? TealKing : TealMan);
+        delta ^= ZOBRIST.pieces[victim][sq];
+    }
+    return delta;
+}
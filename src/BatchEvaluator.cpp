@@ -0,0 +1,178 @@
+#include "BatchEvaluator.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CHECKERS_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+using SquareTables = BatchEvaluator::SquareTables;
+
+/**
+ * @brief Computes the material and piece-square sum of positions [0, count).
+ * Every kernel produces exactly materialScore() for each position.
+ */
+using MaterialKernel = void (*)(const Bitboard *positions, int count, const SquareTables &tables,
+                                int *material);
+
+void scalarKernel(const Bitboard *positions, int count, const SquareTables &tables, int *material) {
+    for (int i = 0; i < count; ++i) {
+        const Bitboard &bb = positions[i];
+        int score = 0;
+        for (std::uint32_t p = bb.teal & ~bb.kings; p; p &= p - 1) score += tables.tealMen[lowestSquare(p)];
+        for (std::uint32_t p = bb.teal & bb.kings; p; p &= p - 1) score += tables.tealKings[lowestSquare(p)];
+        for (std::uint32_t p = bb.purple & ~bb.kings; p; p &= p - 1) score += tables.purpleMen[lowestSquare(p)];
+        for (std::uint32_t p = bb.purple & bb.kings; p; p &= p - 1) score += tables.purpleKings[lowestSquare(p)];
+        material[i] = score;
+    }
+}
+
+#if defined(CHECKERS_AVX2_KERNEL)
+
+/**
+ * @brief AVX2 kernel: eight positions per step, one 32-bit lane each.
+ * For every square, each piece mask is compared against the square's bit and the
+ * resulting all-ones lanes select that square's weight.
+ */
+__attribute__((target("avx2")))
+inline __m256i addIfSet(__m256i acc, __m256i pieces, __m256i bit, std::int32_t weight) {
+    __m256i on = _mm256_cmpeq_epi32(_mm256_and_si256(pieces, bit), bit);
+    return _mm256_add_epi32(acc, _mm256_and_si256(on, _mm256_set1_epi32(weight)));
+}
+
+__attribute__((target("avx2")))
+void avx2Kernel(const Bitboard *positions, int count, const SquareTables &tables, int *material) {
+    static_assert(sizeof(Bitboard) == 3 * sizeof(std::uint32_t), "Bitboard is gathered as three words");
+    const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int *base = reinterpret_cast<const int *>(positions + i);
+        __m256i teal = _mm256_i32gather_epi32(base, stride, 4);
+        __m256i purple = _mm256_i32gather_epi32(base + 1, stride, 4);
+        __m256i kings = _mm256_i32gather_epi32(base + 2, stride, 4);
+
+        __m256i tealMen = _mm256_andnot_si256(kings, teal);
+        __m256i tealKings = _mm256_and_si256(kings, teal);
+        __m256i purpleMen = _mm256_andnot_si256(kings, purple);
+        __m256i purpleKings = _mm256_and_si256(kings, purple);
+
+        __m256i acc = _mm256_setzero_si256();
+        for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+            const __m256i bit = _mm256_set1_epi32(static_cast<int>(squareBit(sq)));
+            acc = addIfSet(acc, tealMen, bit, tables.tealMen[sq]);
+            acc = addIfSet(acc, tealKings, bit, tables.tealKings[sq]);
+            acc = addIfSet(acc, purpleMen, bit, tables.purpleMen[sq]);
+            acc = addIfSet(acc, purpleKings, bit, tables.purpleKings[sq]);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(material + i), acc);
+    }
+    scalarKernel(positions + i, count - i, tables, material + i);
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+/**
+ * @brief NEON kernel: four positions per step, one 32-bit lane each.
+ * vld3q splits four packed Bitboards into their teal, purple and king masks.
+ */
+inline int32x4_t addIfSet(int32x4_t acc, uint32x4_t pieces, uint32x4_t bit, std::int32_t weight) {
+    uint32x4_t on = vtstq_u32(pieces, bit);
+    return vaddq_s32(acc, vreinterpretq_s32_u32(vandq_u32(on, vreinterpretq_u32_s32(vdupq_n_s32(weight)))));
+}
+
+void neonKernel(const Bitboard *positions, int count, const SquareTables &tables, int *material) {
+    static_assert(sizeof(Bitboard) == 3 * sizeof(std::uint32_t), "Bitboard is loaded as three words");
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4x3_t masks = vld3q_u32(reinterpret_cast<const std::uint32_t *>(positions + i));
+        uint32x4_t tealMen = vbicq_u32(masks.val[0], masks.val[2]);
+        uint32x4_t tealKings = vandq_u32(masks.val[0], masks.val[2]);
+        uint32x4_t purpleMen = vbicq_u32(masks.val[1], masks.val[2]);
+        uint32x4_t purpleKings = vandq_u32(masks.val[1], masks.val[2]);
+
+        int32x4_t acc = vdupq_n_s32(0);
+        for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+            const uint32x4_t bit = vdupq_n_u32(squareBit(sq));
+            acc = addIfSet(acc, tealMen, bit, tables.tealMen[sq]);
+            acc = addIfSet(acc, tealKings, bit, tables.tealKings[sq]);
+            acc = addIfSet(acc, purpleMen, bit, tables.purpleMen[sq]);
+            acc = addIfSet(acc, purpleKings, bit, tables.purpleKings[sq]);
+        }
+        vst1q_s32(material + i, acc);
+    }
+    scalarKernel(positions + i, count - i, tables, material + i);
+}
+
+#endif
+
+struct KernelChoice {
+    MaterialKernel kernel;
+    const char *name;
+};
+
+/**
+ * @brief Picks the fastest kernel this build and CPU support; decided once per process.
+ */
+const KernelChoice &kernelChoice() {
+    static const KernelChoice choice = []() -> KernelChoice {
+#if defined(CHECKERS_AVX2_KERNEL)
+        if (__builtin_cpu_supports("avx2")) {
+            return {avx2Kernel, "avx2"};
+        }
+#endif
+#if defined(__ARM_NEON)
+        return {neonKernel, "neon"};
+#else
+        return {scalarKernel, "scalar"};
+#endif
+    }();
+    return choice;
+}
+
+} // namespace
+
+/**
+ * @brief Prepares the per-square tables for a set of weights.
+ * @param weights The weights to evaluate with (copied)
+ */
+BatchEvaluator::BatchEvaluator(const EvalWeights &weights) : weights(weights) {
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        // Purple reads the tables from its own side of the board, as in materialScore().
+        int mirrored = NUM_SQUARES - 1 - sq;
+        tables.tealMen[sq] = weights.manValue + weights.manSquares[sq];
+        tables.tealKings[sq] = weights.kingValue + weights.kingSquares[sq];
+        tables.purpleMen[sq] = -(weights.manValue + weights.manSquares[mirrored]);
+        tables.purpleKings[sq] = -(weights.kingValue + weights.kingSquares[mirrored]);
+    }
+}
+
+/**
+ * @brief Evaluates a batch of positions.
+ * @param positions The positions to evaluate
+ * @param sides The side to move in each position (TealMan or PurpleMan)
+ * @param count Number of positions
+ * @param scores Output array receiving evaluatePosition() of each position
+ */
+void BatchEvaluator::evaluate(const Bitboard *positions, const Piece *sides, int count, int *scores) const {
+    kernelChoice().kernel(positions, count, tables, scores);
+    for (int i = 0; i < count; ++i) {
+        scores[i] = evaluateWithMaterial(positions[i], sides[i], scores[i], weights);
+    }
+}
+
+/**
+ * @brief Gets the name of the kernel evaluate() runs on this machine.
+ * @return "avx2", "neon" or "scalar"
+ */
+const char *BatchEvaluator::kernelName() {
+    return kernelChoice().name;
+}
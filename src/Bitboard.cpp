@@ -0,0 +1,469 @@
+#include "Bitboard.h"
+
+#include <array>
+
+namespace {
+
+constexpr std::uint32_t EVEN_ROWS  = 0x0F0F0F0Fu; ///< Rows 0, 2, 4, 6 (dark squares on odd columns)
+constexpr std::uint32_t ODD_ROWS   = 0xF0F0F0F0u; ///< Rows 1, 3, 5, 7 (dark squares on even columns)
+constexpr std::uint32_t FIRST_FILE = 0x11111111u; ///< First dark square of every row
+constexpr std::uint32_t LAST_FILE  = 0x88888888u; ///< Last dark square of every row
+constexpr std::uint32_t TOP_ROW    = 0x0000000Fu; ///< Row 0, where Teal men are crowned
+constexpr std::uint32_t BOTTOM_ROW = 0xF0000000u; ///< Row 7, where Purple men are crowned
+
+// Diagonal neighbour shifts. "Up" is toward row 0 (Teal's forward direction),
+// "down" is toward row 7 (Purple's forward direction). The packed index step
+// depends on row parity, so each shift handles even and odd rows separately.
+
+constexpr std::uint32_t upLeft(std::uint32_t b) {
+    return ((b & EVEN_ROWS) >> 4) | ((b & ODD_ROWS & ~FIRST_FILE) >> 5);
+}
+
+constexpr std::uint32_t upRight(std::uint32_t b) {
+    return ((b & EVEN_ROWS & ~LAST_FILE) >> 3) | ((b & ODD_ROWS) >> 4);
+}
+
+constexpr std::uint32_t downLeft(std::uint32_t b) {
+    return ((b & EVEN_ROWS) << 4) | ((b & ODD_ROWS & ~FIRST_FILE) << 3);
+}
+
+constexpr std::uint32_t downRight(std::uint32_t b) {
+    return ((b & EVEN_ROWS & ~LAST_FILE) << 5) | ((b & ODD_ROWS) << 4);
+}
+
+/**
+ * @brief Diagonal directions, indexed into the neighbour tables below.
+ * Opposite directions add up to 3.
+ */
+enum Direction { UpLeftDir = 0, UpRightDir = 1, DownLeftDir = 2, DownRightDir = 3 };
+
+constexpr int DIR_ROW[4] = {-1, -1, 1, 1};
+constexpr int DIR_COL[4] = {-1, 1, -1, 1};
+
+/**
+ * @brief Shifts every square of a mask one step in a direction fixed at compile time.
+ */
+template <int Dir>
+constexpr std::uint32_t shift(std::uint32_t b) {
+    if constexpr (Dir == UpLeftDir) return upLeft(b);
+    else if constexpr (Dir == UpRightDir) return upRight(b);
+    else if constexpr (Dir == DownLeftDir) return downLeft(b);
+    else return downRight(b);
+}
+
+/**
+ * @brief Everything about a side that move generation needs, resolved at compile time.
+ */
+template <Side S>
+struct SideTraits {
+    static constexpr bool TEAL = S == Side::Teal;
+    static constexpr int FORWARD_LEFT = TEAL ? UpLeftDir : DownLeftDir;   ///< Men move forward only,
+    static constexpr int FORWARD_RIGHT = TEAL ? UpRightDir : DownRightDir; ///< kings also backward
+    static constexpr int BACK_LEFT = 3 - FORWARD_RIGHT;
+    static constexpr int BACK_RIGHT = 3 - FORWARD_LEFT;
+    static constexpr std::uint32_t CROWN_ROW = TEAL ? TOP_ROW : BOTTOM_ROW;
+
+    static std::uint32_t &own(Bitboard &bb) { return TEAL ? bb.teal : bb.purple; }
+    static std::uint32_t &opp(Bitboard &bb) { return TEAL ? bb.purple : bb.teal; }
+    static std::uint32_t own(const Bitboard &bb) { return TEAL ? bb.teal : bb.purple; }
+    static std::uint32_t opp(const Bitboard &bb) { return TEAL ? bb.purple : bb.teal; }
+};
+
+/**
+ * @brief Finds the pieces that can jump in a direction: walk back from an empty landing
+ * square over an opposing piece.
+ */
+template <int Dir>
+constexpr std::uint32_t jumpersToward(std::uint32_t pieces, std::uint32_t opp, std::uint32_t empty) {
+    return shift<3 - Dir>(shift<3 - Dir>(empty) & opp) & pieces;
+}
+
+/**
+ * @brief Per-square lookup of the adjacent and the jump-landing square in each direction.
+ * Entries are -1 where the step would leave the board.
+ */
+struct SquareTables {
+    std::array<std::array<std::int8_t, 4>, NUM_SQUARES> neighbor{};
+    std::array<std::array<std::int8_t, 4>, NUM_SQUARES> jump{};
+};
+
+constexpr SquareTables buildSquareTables() {
+    SquareTables t{};
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        int r = squareRow(sq);
+        int c = squareCol(sq);
+        for (int d = 0; d < 4; ++d) {
+            int nr = r + DIR_ROW[d], nc = c + DIR_COL[d];
+            int jr = r + 2 * DIR_ROW[d], jc = c + 2 * DIR_COL[d];
+            bool nIn = nr >= 0 && nr < BOARD_SIZE && nc >= 0 && nc < BOARD_SIZE;
+            bool jIn = jr >= 0 && jr < BOARD_SIZE && jc >= 0 && jc < BOARD_SIZE;
+            t.neighbor[sq][d] = static_cast<std::int8_t>(nIn ? squareIndex(nr, nc) : -1);
+            t.jump[sq][d] = static_cast<std::int8_t>(jIn ? squareIndex(jr, jc) : -1);
+        }
+    }
+    return t;
+}
+
+constexpr SquareTables TABLES = buildSquareTables();
+
+/**
+ * @brief Extends a jump sequence from the square the piece has just landed on.
+ * Captured pieces stay on the board until the move ends: they cannot be jumped twice
+ * and their squares cannot be landed on.
+ * @tparam FirstDir First direction the piece may jump in; men use two, kings all four
+ * @tparam LastDir Last direction the piece may jump in
+ * @tparam CrownRow Mask of the row that crowns a man, 0 for a king
+ * @param sq Square the jumping piece stands on
+ * @param opp Opposing pieces not yet captured
+ * @param empty Empty squares, including the square the move started from
+ * @param move The sequence so far; restored before returning
+ * @param moves Receives every complete sequence
+ */
+template <int FirstDir, int LastDir, std::uint32_t CrownRow>
+void extendJumps(int sq, std::uint32_t opp, std::uint32_t empty, Move &move, MoveList &moves) {
+    bool extended = false;
+    for (int d = FirstDir; d <= LastDir; ++d) {
+        int n = TABLES.neighbor[sq][d];
+        if (n < 0 || !(opp & squareBit(n))) continue;
+        int j = TABLES.jump[sq][d];
+        if (j < 0 || !(empty & squareBit(j))) continue;
+
+        extended = true;
+        move.path[move.jumps++] = static_cast<std::uint8_t>(j);
+        move.captured |= squareBit(n);
+        if (CrownRow & squareBit(j)) {
+            // Being crowned ends the move.
+            move.to = static_cast<std::uint8_t>(j);
+            moves.push(move);
+        } else {
+            extendJumps<FirstDir, LastDir, CrownRow>(j, opp & ~squareBit(n), empty, move, moves);
+        }
+        move.captured &= ~squareBit(n);
+        --move.jumps;
+    }
+
+    if (!extended && move.jumps > 0) {
+        // A king circling a group of pieces can capture the same set in either order.
+        // Both paths are kept as separate moves, as in the published perft counts.
+        move.to = static_cast<std::uint8_t>(sq);
+        moves.push(move);
+    }
+}
+
+/**
+ * @brief Starts a jump sequence from every piece of a mask.
+ */
+template <int FirstDir, int LastDir, std::uint32_t CrownRow>
+void addJumps(std::uint32_t jumpers, std::uint32_t opp, std::uint32_t empty, MoveList &moves) {
+    for (; jumpers; jumpers &= jumpers - 1) {
+        int sq = lowestSquare(jumpers);
+        Move move;
+        move.from = static_cast<std::uint8_t>(sq);
+        extendJumps<FirstDir, LastDir, CrownRow>(sq, opp, empty | squareBit(sq), move, moves);
+    }
+}
+
+/**
+ * @brief Adds the simple move of every piece of a mask that can step in a direction.
+ * The targets come from one shift; each source is found from its target in the table.
+ */
+template <int Dir>
+void addSteps(std::uint32_t movers, std::uint32_t empty, MoveList &moves) {
+    for (std::uint32_t targets = shift<Dir>(movers) & empty; targets; targets &= targets - 1) {
+        int to = lowestSquare(targets);
+        Move move;
+        move.from = static_cast<std::uint8_t>(TABLES.neighbor[to][3 - Dir]);
+        move.to = static_cast<std::uint8_t>(to);
+        moves.push(move);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Packs the board of a GameState into a Bitboard.
+ * @param state The game state to convert
+ * @return The packed position
+ */
+Bitboard toBitboard(const GameState &state) {
+    Bitboard bb;
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        Piece pc = state.board[squareRow(sq)][squareCol(sq)];
+        if (isTealPiece(pc)) bb.teal |= squareBit(sq);
+        else if (isPurplePiece(pc)) bb.purple |= squareBit(sq);
+        if (pc == TealKing || pc == PurpleKing) bb.kings |= squareBit(sq);
+    }
+    return bb;
+}
+
+/**
+ * @brief Unpacks a Bitboard into the board of a GameState.
+ * Only the board is overwritten; the current player and selection are left untouched.
+ * @param bb The packed position
+ * @param state The game state whose board will be replaced
+ */
+void fromBitboard(const Bitboard &bb, GameState &state) {
+    for (auto &row : state.board) {
+        row.fill(Empty);
+    }
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        state.board[squareRow(sq)][squareCol(sq)] = pieceAt(bb, sq);
+    }
+}
+
+/**
+ * @brief Gets the piece standing on a packed square.
+ * @param bb The position to inspect
+ * @param sq Packed square index in [0, NUM_SQUARES)
+ * @return The piece on the square, or Empty
+ */
+Piece pieceAt(const Bitboard &bb, int sq) {
+    std::uint32_t bit = squareBit(sq);
+    bool king = (bb.kings & bit) != 0;
+    if (bb.teal & bit) return king ? TealKing : TealMan;
+    if (bb.purple & bit) return king ? PurpleKing : PurpleMan;
+    return Empty;
+}
+
+/**
+ * @brief Applies a move on a packed board if it is legal according to checkers rules.
+ * Same rules as the GameState overload: the move must match a generated move from its source
+ * to its final square; a multi-jump is played in full.
+ * @param bb The position (will be modified if move is valid)
+ * @param from Packed source square
+ * @param to Packed target square
+ * @param wasCapture Output parameter set to true if a capture occurred, false otherwise
+ * @return true if the move was valid and applied, false if the move was invalid
+ */
+bool applyMove(Bitboard &bb, int from, int to, bool &wasCapture) {
+    wasCapture = false;
+
+    if (from < 0 || from >= NUM_SQUARES || to < 0 || to >= NUM_SQUARES) return false;
+
+    std::uint32_t fromBit = squareBit(from);
+    if (!((bb.teal | bb.purple) & fromBit)) return false;
+
+    MoveList moves;
+    generateMoves(bb, (bb.teal & fromBit) ? TealMan : PurpleMan, moves);
+    for (const Move &m : moves) {
+        if (m.from == from && m.to == to) {
+            makeMove(bb, m);
+            wasCapture = m.isCapture();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Plays a move of the given side in place on a packed board without validating it.
+ * @tparam S The side that makes the move
+ * @param bb The position to modify
+ * @param move A legal move from generateMoves<S>() for the current position
+ * @return The record needed to take the move back with unmakeMove()
+ */
+template <Side S>
+UndoRecord makeMove(Bitboard &bb, const Move &move) {
+    using T = SideTraits<S>;
+    UndoRecord undo;
+    std::uint32_t fromBit = squareBit(move.from);
+    std::uint32_t toBit = squareBit(move.to);
+
+    undo.capturedKings = bb.kings & move.captured;
+    T::opp(bb) &= ~move.captured;
+    bb.kings &= ~move.captured;
+
+    // XOR rather than OR the two squares: a king's jump sequence can end where it began.
+    T::own(bb) ^= fromBit ^ toBit;
+    if (bb.kings & fromBit) {
+        bb.kings ^= fromBit ^ toBit;
+    } else if (toBit & T::CROWN_ROW) {
+        bb.kings |= toBit;
+        undo.promoted = true;
+    }
+
+    return undo;
+}
+
+/**
+ * @brief Takes back a move of the given side played with makeMove<S>().
+ * @tparam S The side that made the move
+ * @param bb The position to restore
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+template <Side S>
+void unmakeMove(Bitboard &bb, const Move &move, const UndoRecord &undo) {
+    using T = SideTraits<S>;
+    std::uint32_t fromBit = squareBit(move.from);
+    std::uint32_t toBit = squareBit(move.to);
+
+    if (undo.promoted) {
+        bb.kings &= ~toBit;
+    } else if (bb.kings & toBit) {
+        bb.kings ^= fromBit ^ toBit;
+    }
+    T::own(bb) ^= fromBit ^ toBit;
+
+    T::opp(bb) |= move.captured;
+    bb.kings |= undo.capturedKings;
+}
+
+/**
+ * @brief Plays a move in place on a packed board without validating it.
+ * The move must come from generateMoves() for the current position.
+ * @param bb The position to modify
+ * @param move The legal move to play
+ * @return The record needed to take the move back with unmakeMove()
+ */
+UndoRecord makeMove(Bitboard &bb, const Move &move) {
+    return (bb.teal & squareBit(move.from)) ? makeMove<Side::Teal>(bb, move)
+                                            : makeMove<Side::Purple>(bb, move);
+}
+
+/**
+ * @brief Takes back a move played with makeMove(), restoring the previous position exactly.
+ * @param bb The position to restore
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+void unmakeMove(Bitboard &bb, const Move &move, const UndoRecord &undo) {
+    if (bb.teal & squareBit(move.to)) {
+        unmakeMove<Side::Teal>(bb, move, undo);
+    } else {
+        unmakeMove<Side::Purple>(bb, move, undo);
+    }
+}
+
+/**
+ * @brief Generates all legal moves of the given side on a packed board.
+ * Colour and direction are compile-time constants, so the only branches left are on
+ * the position itself. Captures are mandatory: if any piece can jump, only complete
+ * jump sequences are generated.
+ * @tparam S The side to generate moves for
+ * @param bb The position to analyze
+ * @param moves Output list, cleared and then filled with every legal move
+ */
+template <Side S>
+void generateMoves(const Bitboard &bb, MoveList &moves) {
+    using T = SideTraits<S>;
+    moves.clear();
+
+    const std::uint32_t own = T::own(bb);
+    const std::uint32_t opp = T::opp(bb);
+    const std::uint32_t men = own & ~bb.kings;
+    const std::uint32_t kings = own & bb.kings;
+    const std::uint32_t empty = emptySquares(bb);
+
+    // Find the pieces that can jump with whole-board shifts before walking any sequence.
+    std::uint32_t manJumpers = jumpersToward<T::FORWARD_LEFT>(men, opp, empty) |
+                               jumpersToward<T::FORWARD_RIGHT>(men, opp, empty);
+    std::uint32_t kingJumpers = jumpersToward<UpLeftDir>(kings, opp, empty) |
+                                jumpersToward<UpRightDir>(kings, opp, empty) |
+                                jumpersToward<DownLeftDir>(kings, opp, empty) |
+                                jumpersToward<DownRightDir>(kings, opp, empty);
+    if (manJumpers | kingJumpers) {
+        addJumps<T::FORWARD_LEFT, T::FORWARD_RIGHT, T::CROWN_ROW>(manJumpers, opp, empty, moves);
+        addJumps<UpLeftDir, DownRightDir, 0>(kingJumpers, opp, empty, moves);
+        return;
+    }
+
+    addSteps<T::FORWARD_LEFT>(own, empty, moves);
+    addSteps<T::FORWARD_RIGHT>(own, empty, moves);
+    addSteps<T::BACK_LEFT>(kings, empty, moves);
+    addSteps<T::BACK_RIGHT>(kings, empty, moves);
+}
+
+/**
+ * @brief Generates all legal moves for one player on a packed board.
+ * Captures are mandatory: if any piece can jump, only complete jump sequences are
+ * generated, each continuing until no further jump is possible or the piece is crowned.
+ * @param bb The position to analyze
+ * @param side The piece type representing the player (TealMan, PurpleMan, TealKing, or PurpleKing)
+ * @param moves Output list, cleared and then filled with every legal move
+ */
+void generateMoves(const Bitboard &bb, Piece side, MoveList &moves) {
+    if (isTealPiece(side)) {
+        generateMoves<Side::Teal>(bb, moves);
+    } else {
+        generateMoves<Side::Purple>(bb, moves);
+    }
+}
+
+/**
+ * @brief Counts the total number of pieces (men + kings) for each player using popcount.
+ * @param bb The position to analyze
+ * @param tealCount Output parameter for the number of Teal pieces
+ * @param purpleCount Output parameter for the number of Purple pieces
+ */
+void countPieces(const Bitboard &bb, int &tealCount, int &purpleCount) {
+    tealCount = popCount(bb.teal);
+    purpleCount = popCount(bb.purple);
+}
+
+/**
+ * @brief Checks if the given side has at least one legal move available.
+ * Uses whole-board shifts instead of probing individual target squares.
+ * @tparam S The side to check
+ * @param bb The position to analyze
+ * @return true if the side has at least one legal move, false otherwise
+ */
+template <Side S>
+bool hasAnyMoves(const Bitboard &bb) {
+    using T = SideTraits<S>;
+    const std::uint32_t own = T::own(bb);
+    const std::uint32_t opp = T::opp(bb);
+    const std::uint32_t kings = own & bb.kings;
+    const std::uint32_t empty = emptySquares(bb);
+
+    // Men only move forward; kings move both ways.
+    if ((shift<T::FORWARD_LEFT>(own) | shift<T::FORWARD_RIGHT>(own) |
+         shift<T::BACK_LEFT>(kings) | shift<T::BACK_RIGHT>(kings)) & empty) {
+        return true;
+    }
+
+    // Jumps: the neighbour must be an opponent and the square beyond it empty.
+    return (jumpersToward<T::FORWARD_LEFT>(own, opp, empty) |
+            jumpersToward<T::FORWARD_RIGHT>(own, opp, empty) |
+            jumpersToward<T::BACK_LEFT>(kings, opp, empty) |
+            jumpersToward<T::BACK_RIGHT>(kings, opp, empty)) != 0;
+}
+
+/**
+ * @brief Counts the simple moves of the given side with whole-board shifts, ignoring
+ * captures; a cheap mobility measure for the evaluation.
+ * @tparam S The side to count for
+ * @param bb The position to analyze
+ * @return Number of (source, target) pairs of one diagonal step onto an empty square
+ */
+template <Side S>
+int countSimpleMoves(const Bitboard &bb) {
+    using T = SideTraits<S>;
+    const std::uint32_t own = T::own(bb);
+    const std::uint32_t kings = own & bb.kings;
+    const std::uint32_t empty = emptySquares(bb);
+    return popCount(shift<T::FORWARD_LEFT>(own) & empty) + popCount(shift<T::FORWARD_RIGHT>(own) & empty) +
+           popCount(shift<T::BACK_LEFT>(kings) & empty) + popCount(shift<T::BACK_RIGHT>(kings) & empty);
+}
+
+/**
+ * @brief Checks if the given player has at least one legal move available.
+ * Uses whole-board shifts instead of probing individual target squares.
+ * @param bb The position to analyze
+ * @param player The piece type representing the player (TealMan, PurpleMan, TealKing, or PurpleKing)
+ * @return true if the player has at least one legal move, false otherwise
+ */
+bool hasAnyMoves(const Bitboard &bb, Piece player) {
+    return isTealPiece(player) ? hasAnyMoves<Side::Teal>(bb) : hasAnyMoves<Side::Purple>(bb);
+}
+
+template UndoRecord makeMove<Side::Teal>(Bitboard &, const Move &);
+template UndoRecord makeMove<Side::Purple>(Bitboard &, const Move &);
+template void unmakeMove<Side::Teal>(Bitboard &, const Move &, const UndoRecord &);
+template void unmakeMove<Side::Purple>(Bitboard &, const Move &, const UndoRecord &);
+template void generateMoves<Side::Teal>(const Bitboard &, MoveList &);
+template void generateMoves<Side::Purple>(const Bitboard &, MoveList &);
+template bool hasAnyMoves<Side::Teal>(const Bitboard &);
+template bool hasAnyMoves<Side::Purple>(const Bitboard &);
+template int countSimpleMoves<Side::Teal>(const Bitboard &);
+template int countSimpleMoves<Side::Purple>(const Bitboard &);
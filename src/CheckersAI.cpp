@@ -1,31 +1,70 @@
 #include "CheckersAI.h"
+#include "Bitboard.h"
+#include "Notation.h"
+#include "Profiler.h"
 
-#include <vector>
-#include <cmath>
-#include <limits>
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
 
 namespace {
 
+const char *sourceName(MoveSource source) {
+    switch (source) {
+        case MoveSource::Search: return "search";
+        case MoveSource::Book:   return "book";
+        case MoveSource::Random: return "random";
+    }
+    return "?";
+}
+
 /**
- * @brief Internal structure representing a possible move.
+ * @brief Formats a chosen move and its search statistics as one line of JSON.
+ * @param side The side that moves
+ * @param chosen The move and statistics
+ * @return The line, without a trailing newline
  */
-struct Move {
-    int sr, sc;      ///< Source row and column
-    int tr, tc;      ///< Target row and column
-    bool isCapture;  ///< Whether this move captures an opponent piece
-};
+std::string statsToJson(Piece side, const AIMove &chosen) {
+    const SearchStats &st = chosen.stats;
+    char rates[160];
+    std::snprintf(rates, sizeof(rates),
+                  "\"nps\": %.0f, \"tt_hit_rate\": %.4f, \"cutoff_ratio\": %.4f, \"first_move_cutoff_rate\": %.4f",
+                  st.nps(), st.ttHitRate(), st.cutoffRatio(), st.firstMoveCutoffRate());
+
+    std::ostringstream out;
+    out << "{\"side\": \"" << (isTealPiece(side) ? "teal" : "purple") << "\""
+        << ", \"source\": \"" << sourceName(chosen.source) << "\""
+        << ", \"move\": \"" << moveToString(chosen.move) << "\""
+        << ", \"score\": " << chosen.score
+        << ", \"depth\": " << st.depth
+        << ", \"nodes\": " << st.nodes
+        << ", \"time_ms\": " << st.timeMs
+        << ", " << rates
+        << ", \"tb_hits\": " << st.tbHits
+        << ", \"ponder_hit\": " << (chosen.ponderHit ? "true" : "false")
+        << ", \"iterations\": [";
+    for (std::size_t i = 0; i < st.iterations.size(); ++i) {
+        const IterationStats &it = st.iterations[i];
+        out << (i ? ", " : "") << "{\"depth\": " << it.depth << ", \"score\": " << it.score
+            << ", \"nodes\": " << it.nodes << ", \"time_ms\": " << it.timeMs << "}";
+    }
+    out << "], \"pv\": [";
+    for (std::size_t i = 0; i < st.pv.size(); ++i) {
+        out << (i ? ", " : "") << "\"" << moveToString(st.pv[i]) << "\"";
+    }
+    out << "]}";
+    return out.str();
+}
 
 /**
- * @brief Evaluates a game position from the Purple player's perspective.
- * Returns the difference between Purple and Teal piece counts.
- * @param state The game state to evaluate
- * @return Positive value if Purple is ahead, negative if Teal is ahead
+ * @brief Checks whether two moves of the same position are the same move.
+ * Moves with the same squares and captures have the same effect, whatever the path.
  */
-int evaluatePosition(const GameState &state) {
-    int tealCount = 0;
-    int purpleCount = 0;
-    countPieces(state, tealCount, purpleCount);
-    return purpleCount - tealCount;
+bool sameMove(const Move &a, const Move &b) {
+    return a.from == b.from && a.to == b.to && a.captured == b.captured;
 }
 
 } // namespace
@@ -33,28 +72,198 @@ int evaluatePosition(const GameState &state) {
 /**
  * @brief Constructs a new CheckersAI instance.
  * @param difficulty The difficulty level (Easy, Medium, or Hard)
- * Initializes the random number generator used for move selection.
+ * @param threads Number of search threads (Lazy SMP); values below 1 are treated as 1
+ * Initializes the random number generator used for move selection and the
+ * default search budget for the difficulty.
+ */
+CheckersAI::CheckersAI(AIDifficulty difficulty, int threads)
+    : CheckersAI(difficulty, threads, std::random_device{}()) {}
+
+/**
+ * @brief Constructs a CheckersAI whose random choices repeat from run to run.
+ * Two AIs with the same seed, settings and moves make the same random choices;
+ * combine with setDeterministic() for searches that repeat as well.
+ * @param difficulty The difficulty level (Easy, Medium, or Hard)
+ * @param threads Number of search threads (Lazy SMP); values below 1 are treated as 1
+ * @param seed Seed of the random number generator used for move selection
  */
-CheckersAI::CheckersAI(AIDifficulty difficulty)
-    : rng(std::random_device{}()), difficulty(difficulty) {
+CheckersAI::CheckersAI(AIDifficulty difficulty, int threads, std::uint32_t seed)
+    : rng(seed), difficulty(difficulty) {
     // Set optimal move chance based on difficulty
     switch (difficulty) {
         case AIDifficulty::Easy:
             optimalMoveChance = 0.30f;  // 30% optimal moves
+            limits.maxDepth = 2;
             break;
         case AIDifficulty::Medium:
             optimalMoveChance = 0.60f;  // 60% optimal moves
+            limits.maxDepth = 4;
             break;
         case AIDifficulty::Hard:
             optimalMoveChance = 1.0f;   // 100% optimal moves
+            limits.timeLimitMs = 1000;  // search as deep as one second allows
             break;
     }
+
+    engine.setTranspositionTable(&table);
+    engine.setStopFlag(&stopSearch);
+    engine.setTablebase(&tablebase);
+    engine.setEvalWeights(&weights);
+    for (int i = 1; i < threads; ++i) {
+        helpers.push_back(std::make_unique<SearchEngine>());
+        helpers.back()->setTranspositionTable(&table);
+        helpers.back()->setStopFlag(&stopSearch);
+        helpers.back()->setTablebase(&tablebase);
+        helpers.back()->setEvalWeights(&weights);
+    }
+}
+
+/**
+ * @brief Stops any pondering search before the AI is destroyed.
+ */
+CheckersAI::~CheckersAI() {
+    stopPondering();
+}
+
+/**
+ * @brief Discards everything learned by earlier searches, e.g. before a new game:
+ * the transposition table and the move-ordering history.
+ * Must not be called while the AI is thinking.
+ */
+void CheckersAI::clearHash() {
+    table.clear();
+    engine.clearHistory();
+    for (auto &helper : helpers) {
+        helper->clearHistory();
+    }
+}
+
+/**
+ * @brief Runs the main search with helpers on their own threads sharing the table.
+ * A deterministic AI runs the main search alone, on a node budget instead of the clock.
+ * @param bb The position to search
+ * @param side The side to move
+ * @param searchLimits Budget of the search
+ * @param maxHelpers Most helper threads to use besides the main search
+ * @return The main search's result, with the counters summed over all threads
+ */
+SearchResult CheckersAI::runSearch(const Bitboard &bb, Piece side, const SearchLimits &searchLimits,
+                                   std::size_t maxHelpers) {
+    PROFILE_SCOPE("CheckersAI::runSearch");
+    table.newSearch();
+
+    SearchLimits budget = searchLimits;
+    if (deterministic && budget.timeLimitMs > 0) {
+        std::uint64_t nodes = budget.timeLimitMs * DETERMINISTIC_NODES_PER_MS;
+        budget.nodeLimit = budget.nodeLimit > 0 ? std::min(budget.nodeLimit, nodes) : nodes;
+        budget.timeLimitMs = 0;
+    }
+    const std::size_t helperCount = deterministic ? 0 : std::min(maxHelpers, helpers.size());
+
+    std::vector<SearchResult> helperResults(helperCount);
+    std::vector<std::thread> threads;
+    threads.reserve(helperCount);
+    for (std::size_t i = 0; i < helperCount; ++i) {
+        threads.emplace_back([this, &bb, side, &budget, &helperResults, i]() {
+            helperResults[i] = helpers[i]->search(bb, side, budget, static_cast<int>(i) + 1);
+        });
+    }
+
+    // The main thread decides when the search is over; helpers only feed the table.
+    SearchResult result = engine.search(bb, side, budget);
+    stopSearch.store(true);
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (const auto &h : helperResults) {
+        result.stats.addCounters(h.stats);
+    }
+    // nps() then covers every thread over the main search's wall time.
+    PROFILE_COUNTER("searchNodes", result.stats.nodes);
+    return result;
+}
+
+/**
+ * @brief Chooses a move for the side to move: with the difficulty's probability a book
+ * move, or the search's best move if the book does not know the position; otherwise a
+ * random legal move.
+ * @param state The current game state
+ * @param pondered The pondering search of this position, or an invalid future; it is
+ *        used instead of a new search, or stopped if the move does not need one
+ * @return The chosen move
+ */
+AIMove CheckersAI::selectMove(const GameState &state, std::future<SearchResult> &pondered) {
+    PROFILE_SCOPE("CheckersAI::selectMove");
+    AIMove result;
+    Bitboard bb = toBitboard(state);
+    Piece side = isTealPiece(state.currentPlayer) ? TealMan : PurpleMan;
+
+    // Generate all legal moves for the side to move (men + kings).
+    MoveList allMoves;
+    generateMoves(bb, side, allMoves);
+
+    if (allMoves.empty()) {
+        return result;
+    }
+    hasPrediction = false;
+
+    std::uniform_real_distribution<double> prob(0.0, 1.0);
+
+    if (prob(rng) < optimalMoveChance) {
+        // Based on difficulty, play a book move if the opening book knows the
+        // position, otherwise the move the search judges best.
+        if (book.chooseMove(bb, side, allMoves, rng, result.move)) {
+            result.source = MoveSource::Book;
+        } else {
+            SearchResult searched;
+            if (pondered.valid()) {
+                // The time spent pondering counts towards the budget, so only what is
+                // left of it is waited for; usually the search is already done.
+                if (limits.timeLimitMs > 0 &&
+                    pondered.wait_until(ponderStart + std::chrono::milliseconds(limits.timeLimitMs)) ==
+                        std::future_status::timeout) {
+                    stopSearch.store(true);
+                }
+                searched = pondered.get();
+                result.ponderHit = true;
+            } else {
+                searched = runSearch(bb, side, limits, helpers.size());
+            }
+            result.move = searched.bestMove;
+            result.source = MoveSource::Search;
+            result.score = searched.score;
+            result.stats = std::move(searched.stats);
+            if (result.stats.pv.size() >= 2) {
+                predictedReply = result.stats.pv[1];
+                hasPrediction = true;
+            }
+        }
+    } else {
+        // Otherwise, pick any legal move.
+        std::uniform_int_distribution<int> pickAll(0, allMoves.size() - 1);
+        result.move = allMoves[pickAll(rng)];
+    }
+    result.found = true;
+    if (pondered.valid()) {
+        stopSearch.store(true);
+        pondered.wait();
+    }
+
+    if (statsLog) {
+        std::string line = statsToJson(side, result);
+        static std::mutex logMutex;  // shared by every AI, as they may share a stream
+        std::lock_guard<std::mutex> lock(logMutex);
+        *statsLog << line << '\n';
+        statsLog->flush();
+    }
+    return result;
 }
 
 /**
- * @brief Chooses a move for the Purple player based on the current game state.
- * Evaluates all legal moves and selects either the best move (50% chance) or
- * a random legal move (50% chance).
+ * @brief Chooses a move for the side to move based on the current game state.
+ * Searches for the best move and plays it with the difficulty's probability,
+ * otherwise plays a random legal move.
  * @param state The current game state
  * @param srcRow Output parameter for the source row index of the chosen move
  * @param srcCol Output parameter for the source column index of the chosen move
@@ -65,76 +274,132 @@ CheckersAI::CheckersAI(AIDifficulty difficulty)
 bool CheckersAI::chooseMove(const GameState &state,
                             int &srcRow, int &srcCol,
                             int &dstRow, int &dstCol) {
-    std::vector<Move> allMoves;
-
-    // Generate all legal moves for Purple (men + kings).
-    for (int r = 0; r < BOARD_SIZE; ++r) {
-        for (int c = 0; c < BOARD_SIZE; ++c) {
-            Piece p = state.board[r][c];
-            if (!(p == PurpleMan || p == PurpleKing)) continue;
-
-            bool dummyCapture = false;
-            // Try all possible target squares in a 2-step diagonal neighborhood.
-            for (int dr = -2; dr <= 2; ++dr) {
-                if (dr == 0) continue;
-                for (int dc = -2; dc <= 2; ++dc) {
-                    if (dc == 0) continue;
-                    int tr = r + dr;
-                    int tc = c + dc;
-                    GameState tmp = state;
-                    if (applyMove(tmp, r, c, tr, tc, dummyCapture)) {
-                        allMoves.push_back({r, c, tr, tc, dummyCapture});
-                    }
-                }
-            }
-        }
-    }
-
-    if (allMoves.empty()) {
+    std::future<SearchResult> pondered = takePonderSearch(state);
+    AIMove chosen = selectMove(state, pondered);
+    if (!chosen.found) {
         return false;
     }
 
-    // Evaluate moves and find the best ones.
-    std::vector<Move> bestMoves;
-    int bestScore = std::numeric_limits<int>::min();
+    srcRow = squareRow(chosen.move.from);
+    srcCol = squareCol(chosen.move.from);
+    dstRow = squareRow(chosen.move.to);
+    dstCol = squareCol(chosen.move.to);
+    return true;
+}
 
-    for (const auto &m : allMoves) {
-        GameState tmp = state;
-        bool dummyCapture = false;
-        applyMove(tmp, m.sr, m.sc, m.tr, m.tc, dummyCapture);
+/**
+ * @brief Chooses a move for the side to move based on the current game state.
+ * @param state The current game state
+ * @param move Output parameter for the chosen move
+ * @return true if a valid move was found, false if no moves are available
+ */
+bool CheckersAI::chooseMove(const GameState &state, Move &move) {
+    std::future<SearchResult> pondered = takePonderSearch(state);
+    AIMove chosen = selectMove(state, pondered);
+    move = chosen.move;
+    return chosen.found;
+}
 
-        int score = evaluatePosition(tmp);
-        if (m.isCapture) {
-            score += 2; // prefer captures slightly more
-        }
+/**
+ * @brief Chooses a move for the side to move and reports how it was found.
+ * @param state The current game state
+ * @return The chosen move with its source, score and search statistics
+ */
+AIMove CheckersAI::chooseMove(const GameState &state) {
+    std::future<SearchResult> pondered = takePonderSearch(state);
+    return selectMove(state, pondered);
+}
 
-        if (score > bestScore) {
-            bestScore = score;
-            bestMoves.clear();
-            bestMoves.push_back(m);
-        } else if (score == bestScore) {
-            bestMoves.push_back(m);
-        }
-    }
+/**
+ * @brief Starts choosing a move for the side to move on a background thread.
+ * Poll the returned future (e.g. wait_for with a zero timeout) once per frame so
+ * rendering continues while the AI thinks. Only one search may run at a time,
+ * and the AI must outlive the future.
+ * @param state The current game state (copied, so the caller may keep modifying it)
+ * @return A future that becomes ready with the chosen move
+ */
+std::future<AIMove> CheckersAI::startThinking(const GameState &state) {
+    PROFILE_SCOPE("CheckersAI::startThinking");
+    // Settle the stop flag before launching so a stopThinking() issued right away is not lost.
+    std::future<SearchResult> pondered = takePonderSearch(state);
+    return std::async(std::launch::async, [this, state, pondered = std::move(pondered)]() mutable {
+        return selectMove(state, pondered);
+    });
+}
 
-    std::uniform_real_distribution<double> prob(0.0, 1.0);
-    std::uniform_int_distribution<std::size_t> pickAll(0, allMoves.size() - 1);
+/**
+ * @brief Starts searching on the opponent's time, right after the AI's own move.
+ * If the last search expected a reply, the position after it is searched with the
+ * AI to move; when the opponent plays that reply, the next move comes from this
+ * search and needs at most what is left of the time budget. Otherwise the
+ * opponent's position itself is searched, which fills the shared transposition
+ * table for every reply. Either way the search runs on half the helper threads
+ * until the next chooseMove() or startThinking(), stopPondering(), the last
+ * iteration the move search would run, or PONDER_TIME_FACTOR times the move's
+ * time limit, whichever comes first.
+ * Does nothing for a deterministic AI, see setDeterministic().
+ * Must not be called while the AI is thinking.
+ * @param state The position after the AI's move, with the opponent to move
+ */
+void CheckersAI::startPondering(const GameState &state) {
+    PROFILE_SCOPE("CheckersAI::startPondering");
+    stopPondering();
+    if (deterministic) {
+        return; // a search on the opponent's time would change what the table holds
+    }
+    ponderBoard = toBitboard(state);
+    ponderSide = isTealPiece(state.currentPlayer) ? TealMan : PurpleMan;
 
-    Move chosen;
-    if (!bestMoves.empty() && prob(rng) < optimalMoveChance) {
-        // Based on difficulty, pick from the best moves.
-        std::uniform_int_distribution<std::size_t> pickBest(0, bestMoves.size() - 1);
-        chosen = bestMoves[pickBest(rng)];
-    } else {
-        // Otherwise, pick any legal move.
-        chosen = allMoves[pickAll(rng)];
+    MoveList replies;
+    generateMoves(ponderBoard, ponderSide, replies);
+    if (replies.empty()) {
+        return; // the game is over
+    }
+    for (const Move &reply : replies) {
+        if (hasPrediction && sameMove(reply, predictedReply)) {
+            ::makeMove(ponderBoard, reply);
+            ponderSide = isTealPiece(ponderSide) ? PurpleMan : TealMan;
+            break;
+        }
     }
 
-    srcRow = chosen.sr;
-    srcCol = chosen.sc;
-    dstRow = chosen.tr;
-    dstCol = chosen.tc;
-    return true;
+    // What is left of the move's own budget is handled when the move is asked for.
+    // The search keeps the depth and node limits and gets a few move budgets of time,
+    // so an opponent who takes long, or leaves, does not keep every core busy.
+    SearchLimits ponderLimits = limits;
+    ponderLimits.timeLimitMs = limits.timeLimitMs * PONDER_TIME_FACTOR;
+    ponderStart = std::chrono::steady_clock::now();
+    stopSearch.store(false);
+    pondering = std::async(std::launch::async, [this, ponderLimits]() {
+        return runSearch(ponderBoard, ponderSide, ponderLimits, helpers.size() / 2);
+    });
 }
 
+/**
+ * @brief Stops a pondering search and discards its result, e.g. before a new game.
+ * Blocks until the search threads have finished.
+ */
+void CheckersAI::stopPondering() {
+    if (!pondering.valid()) return;
+    stopSearch.store(true);
+    pondering.wait();
+    pondering = std::future<SearchResult>();
+}
 
+/**
+ * @brief Hands over the pondering search if it is of the given position, and stops
+ * it otherwise. Readies the stop flag for the search of the move.
+ * @param state The position the AI is about to move in
+ * @return The pondering search on a hit, an invalid future on a miss or when not pondering
+ */
+std::future<SearchResult> CheckersAI::takePonderSearch(const GameState &state) {
+    Bitboard bb = toBitboard(state);
+    Piece side = isTealPiece(state.currentPlayer) ? TealMan : PurpleMan;
+    if (pondering.valid() && side == ponderSide && bb.teal == ponderBoard.teal &&
+        bb.purple == ponderBoard.purple && bb.kings == ponderBoard.kings) {
+        return std::move(pondering);  // still searching, so the stop flag stays down
+    }
+    stopPondering();
+    stopSearch.store(false);
+    return std::future<SearchResult>();
+}
@@ -0,0 +1,248 @@
+#include "EndgameTablebase.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Squares each piece type can stand on. Men never stand on the row where they would
+// be crowned, which keeps their tables smaller.
+constexpr std::uint32_t TEAL_MAN_SQUARES = 0xFFFFFFF0u;   // not row 0
+constexpr std::uint32_t PURPLE_MAN_SQUARES = 0x0FFFFFFFu; // not row 7
+constexpr std::uint32_t KING_SQUARES = 0xFFFFFFFFu;
+
+/**
+ * @brief Binomial coefficients C(n, k) for n <= NUM_SQUARES and k <= TB_MAX_PIECES.
+ */
+struct BinomialTable {
+    std::uint64_t c[NUM_SQUARES + 1][TB_MAX_PIECES + 1]{};
+};
+
+constexpr BinomialTable buildBinomials() {
+    BinomialTable t{};
+    for (int n = 0; n <= NUM_SQUARES; ++n) {
+        t.c[n][0] = 1;
+        for (int k = 1; k <= TB_MAX_PIECES; ++k) {
+            t.c[n][k] = (n == 0) ? 0 : t.c[n - 1][k - 1] + t.c[n - 1][k];
+        }
+    }
+    return t;
+}
+
+constexpr BinomialTable BINOMIAL = buildBinomials();
+
+/**
+ * @brief One piece type of a signature: where it may stand and how many there are.
+ */
+struct Group {
+    std::uint32_t allowed;
+    int count;
+};
+
+void groupsOf(const MaterialSignature &sig, Group groups[4]) {
+    groups[0] = {TEAL_MAN_SQUARES, sig.tealMen};
+    groups[1] = {PURPLE_MAN_SQUARES, sig.purpleMen};
+    groups[2] = {KING_SQUARES, sig.tealKings};
+    groups[3] = {KING_SQUARES, sig.purpleKings};
+}
+
+std::uint64_t groupSize(const Group &g) {
+    return BINOMIAL.c[popCount(g.allowed)][g.count];
+}
+
+/**
+ * @brief Ranks a set of squares in the combinatorial number system over the allowed squares.
+ */
+std::uint64_t rankGroup(std::uint32_t squares, std::uint32_t allowed) {
+    std::uint64_t rank = 0;
+    int i = 1;
+    for (; squares; squares &= squares - 1, ++i) {
+        int sq = lowestSquare(squares);
+        int position = popCount(allowed & (squareBit(sq) - 1));
+        rank += BINOMIAL.c[position][i];
+    }
+    return rank;
+}
+
+/**
+ * @brief Inverse of rankGroup(): the set of squares with the given rank.
+ */
+std::uint32_t unrankGroup(std::uint64_t rank, int count, std::uint32_t allowed) {
+    std::uint32_t squares = 0;
+    int position = popCount(allowed) - 1;
+    for (int i = count; i >= 1; --i) {
+        while (BINOMIAL.c[position][i] > rank) {
+            --position;
+        }
+        rank -= BINOMIAL.c[position][i];
+
+        // Select the position-th allowed square.
+        std::uint32_t remaining = allowed;
+        for (int skip = 0; skip < position; ++skip) {
+            remaining &= remaining - 1;
+        }
+        squares |= squareBit(lowestSquare(remaining));
+        --position;
+    }
+    return squares;
+}
+
+} // namespace
+
+/**
+ * @brief Counts the material of a position.
+ * @param bb The position to inspect
+ * @return The signature of the position
+ */
+MaterialSignature materialOf(const Bitboard &bb) {
+    MaterialSignature sig;
+    sig.tealKings = popCount(bb.teal & bb.kings);
+    sig.tealMen = popCount(bb.teal) - sig.tealKings;
+    sig.purpleKings = popCount(bb.purple & bb.kings);
+    sig.purpleMen = popCount(bb.purple) - sig.purpleKings;
+    return sig;
+}
+
+/**
+ * @brief Gets the number of entries in a material's table, for both sides to move.
+ * Entries whose pieces would share a square exist but are never used.
+ * @param sig The material
+ * @return Number of entries
+ */
+std::uint64_t tablebaseSize(const MaterialSignature &sig) {
+    Group groups[4];
+    groupsOf(sig, groups);
+    std::uint64_t size = 2;
+    for (const Group &g : groups) {
+        size *= groupSize(g);
+    }
+    return size;
+}
+
+/**
+ * @brief Computes where a position is stored in its material's table.
+ * @param bb The position, whose material must be sig
+ * @param side The side to move (TealMan or PurpleMan)
+ * @param sig The material of bb
+ * @return Index in [0, tablebaseSize(sig))
+ */
+std::uint64_t tablebaseIndex(const Bitboard &bb, Piece side, const MaterialSignature &sig) {
+    Group groups[4];
+    groupsOf(sig, groups);
+    const std::uint32_t squares[4] = {
+        bb.teal & ~bb.kings, bb.purple & ~bb.kings, bb.teal & bb.kings, bb.purple & bb.kings,
+    };
+
+    std::uint64_t index = isPurplePiece(side) ? 1 : 0;
+    for (int g = 0; g < 4; ++g) {
+        index = index * groupSize(groups[g]) + rankGroup(squares[g], groups[g].allowed);
+    }
+    return index;
+}
+
+/**
+ * @brief Rebuilds the position stored at an index, the inverse of tablebaseIndex().
+ * @param sig The material of the table
+ * @param index Index in [0, tablebaseSize(sig))
+ * @param bb Output parameter for the position
+ * @param side Output parameter for the side to move
+ * @return false if the index names an impossible position (two pieces on one square)
+ */
+bool tablebasePosition(const MaterialSignature &sig, std::uint64_t index, Bitboard &bb, Piece &side) {
+    Group groups[4];
+    groupsOf(sig, groups);
+
+    std::uint32_t squares[4];
+    for (int g = 3; g >= 0; --g) {
+        std::uint64_t size = groupSize(groups[g]);
+        squares[g] = unrankGroup(index % size, groups[g].count, groups[g].allowed);
+        index /= size;
+    }
+    side = (index == 0) ? TealMan : PurpleMan;
+
+    std::uint32_t occupied = 0;
+    for (std::uint32_t s : squares) {
+        if (occupied & s) return false;
+        occupied |= s;
+    }
+    bb.teal = squares[0] | squares[2];
+    bb.purple = squares[1] | squares[3];
+    bb.kings = squares[2] | squares[3];
+    return true;
+}
+
+/**
+ * @brief Maps a tablebase file, closing any previously opened one.
+ * @param path Path of the file written by checkers_tbgen
+ * @return true if the file was mapped and is valid for the current rules
+ */
+bool EndgameTablebase::open(const std::string &path) {
+    close();
+    if (!openDataFile(file, path, TB_MAGIC, sizeof(TablebaseFileHeader), "Tablebase",
+                      "regenerate it with checkers_tbgen")) {
+        return false;
+    }
+
+    TablebaseFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.maxPieces > TB_MAX_PIECES) {
+        std::cerr << "Tablebase " << path << " has an unknown format\n";
+        close();
+        return false;
+    }
+    if (file.size() < sizeof(header) + std::uint64_t{header.tableCount} * sizeof(TablebaseTableInfo)) {
+        std::cerr << "Tablebase " << path << " is truncated\n";
+        close();
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < header.tableCount; ++i) {
+        TablebaseTableInfo info;
+        std::memcpy(&info, file.data() + sizeof(header) + i * sizeof(info), sizeof(info));
+
+        MaterialSignature sig;
+        sig.tealMen = info.tealMen;
+        sig.tealKings = info.tealKings;
+        sig.purpleMen = info.purpleMen;
+        sig.purpleKings = info.purpleKings;
+        if (sig.total() > static_cast<int>(header.maxPieces) || info.size != tablebaseSize(sig) ||
+            info.offset + info.size > file.size()) {
+            std::cerr << "Tablebase " << path << " has a corrupt directory\n";
+            close();
+            return false;
+        }
+        tables[sig.code()] = {file.data() + info.offset, info.size};
+    }
+
+    pieces = static_cast<int>(header.maxPieces);
+    return true;
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+void EndgameTablebase::close() {
+    file.close();
+    tables.fill(Table{});
+    pieces = 0;
+}
+
+/**
+ * @brief Looks a position up.
+ * @param bb The position to look up
+ * @param side The side to move (TealMan or PurpleMan)
+ * @param result Output parameter filled on success
+ * @return true if the position is covered by the tablebase, false otherwise
+ */
+bool EndgameTablebase::probe(const Bitboard &bb, Piece side, TBResult &result) const {
+    if (popCount(bb.teal | bb.purple) > pieces || bb.teal == 0 || bb.purple == 0) {
+        return false;
+    }
+    MaterialSignature sig = materialOf(bb);
+    const Table &table = tables[sig.code()];
+    if (!table.data) {
+        return false;
+    }
+    result = decodeTablebaseValue(table.data[tablebaseIndex(bb, side, sig)]);
+    return true;
+}
@@ -0,0 +1,197 @@
+#include "Evaluation.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief A tunable term as named in configuration files.
+ */
+struct Term {
+    const char *name;
+    int EvalWeights::*scalar;                          ///< Set for single values
+    std::array<int, NUM_SQUARES> EvalWeights::*table;  ///< Set for piece-square tables
+};
+
+constexpr Term TERMS[] = {
+    {"man", &EvalWeights::manValue, nullptr},
+    {"king", &EvalWeights::kingValue, nullptr},
+    {"mobility", &EvalWeights::mobility, nullptr},
+    {"tempo", &EvalWeights::tempo, nullptr},
+    {"man_squares", nullptr, &EvalWeights::manSquares},
+    {"king_squares", nullptr, &EvalWeights::kingSquares},
+};
+
+/**
+ * @brief Gets the value of a piece on a square, material and square bonus together.
+ * Purple's squares are mirrored so the tables are always read from the owner's side.
+ */
+int pieceValue(Piece piece, int sq, const EvalWeights &w) {
+    switch (piece) {
+        case TealMan:    return w.manValue + w.manSquares[sq];
+        case TealKing:   return w.kingValue + w.kingSquares[sq];
+        case PurpleMan:  return -(w.manValue + w.manSquares[NUM_SQUARES - 1 - sq]);
+        case PurpleKing: return -(w.kingValue + w.kingSquares[NUM_SQUARES - 1 - sq]);
+        default:         return 0;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Gets the weights used when no configuration file has been loaded.
+ * @return The built-in weights
+ */
+const EvalWeights &defaultEvalWeights() {
+    static const EvalWeights weights;
+    return weights;
+}
+
+/**
+ * @brief Reads weights from a configuration file.
+ * The file holds one "name value..." line per term (see assets/eval.cfg); '#' starts a
+ * comment and terms that are not listed keep their current value.
+ * @param path File to read
+ * @param weights Weights to update; left unchanged if the file is invalid
+ * @return true if the file was read, false if it is missing or malformed
+ */
+bool loadEvalWeights(const std::string &path, EvalWeights &weights) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+
+    // Strip comments, then read the file as a stream of names and numbers so a table
+    // may span several lines.
+    std::string text;
+    for (std::string line; std::getline(in, line);) {
+        text += line.substr(0, line.find('#'));
+        text += '\n';
+    }
+
+    EvalWeights parsed = weights;
+    std::istringstream tokens(text);
+    for (std::string name; tokens >> name;) {
+        const Term *term = nullptr;
+        for (const Term &t : TERMS) {
+            if (name == t.name) term = &t;
+        }
+        if (!term) {
+            std::cerr << "Evaluation weights " << path << ": unknown term '" << name << "'\n";
+            return false;
+        }
+
+        bool ok = true;
+        if (term->scalar) {
+            ok = static_cast<bool>(tokens >> (parsed.*term->scalar));
+        } else {
+            for (int &value : parsed.*term->table) {
+                ok = ok && static_cast<bool>(tokens >> value);
+            }
+        }
+        if (!ok) {
+            std::cerr << "Evaluation weights " << path << ": '" << name << "' needs "
+                      << (term->scalar ? 1 : NUM_SQUARES) << " integer value(s)\n";
+            return false;
+        }
+    }
+
+    weights = parsed;
+    return true;
+}
+
+/**
+ * @brief Writes weights in the format loadEvalWeights() reads.
+ * @param path File to write
+ * @param weights The weights to write
+ * @return true if the file was written, false on an I/O error
+ */
+bool saveEvalWeights(const std::string &path, const EvalWeights &weights) {
+    std::ofstream out(path);
+    out << "# Evaluation weights in hundredths of a man.\n"
+        << "# Square tables list packed squares 0-31 row by row from Teal's crown row.\n";
+    for (const Term &term : TERMS) {
+        if (term.scalar) {
+            out << term.name << ' ' << weights.*term.scalar << '\n';
+            continue;
+        }
+        out << term.name;
+        const auto &table = weights.*term.table;
+        for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+            out << (sq % 4 == 0 ? "\n   " : "") << ' ' << table[sq];
+        }
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Computes the material and piece-square score of a position from scratch.
+ * @param bb The position to score
+ * @param weights The weights to use
+ * @return Score from Teal's perspective
+ */
+int materialScore(const Bitboard &bb, const EvalWeights &weights) {
+    int score = 0;
+    for (std::uint32_t pieces = bb.teal | bb.purple; pieces; pieces &= pieces - 1) {
+        int sq = lowestSquare(pieces);
+        score += pieceValue(pieceAt(bb, sq), sq, weights);
+    }
+    return score;
+}
+
+/**
+ * @brief Computes how a move changes materialScore().
+ * Add the result after makeMove(); subtract it to undo the move.
+ * @param after The position after the move was made
+ * @param move The move that was made
+ * @param undo The record makeMove() returned
+ * @param weights The weights to use
+ * @return Change of the score from Teal's perspective
+ */
+int materialMoveDelta(const Bitboard &after, const Move &move, const UndoRecord &undo,
+                      const EvalWeights &weights) {
+    Piece moved = pieceAt(after, move.to);
+    Piece before = moved;
+    if (undo.promoted) {
+        before = isTealPiece(moved) ? TealMan : PurpleMan;
+    }
+
+    int delta = pieceValue(moved, move.to, weights) - pieceValue(before, move.from, weights);
+    bool tealMoved = isTealPiece(moved);
+    for (std::uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        int sq = lowestSquare(captured);
+        bool king = (undo.capturedKings & squareBit(sq)) != 0;
+        Piece victim = tealMoved ? (king ? PurpleKing : PurpleMan) : (king ? TealKing : TealMan);
+        delta -= pieceValue(victim, sq, weights);
+    }
+    return delta;
+}
+
+/**
+ * @brief Completes an evaluation from an up-to-date material score.
+ * Adds mobility and tempo and turns the score to the side to move's perspective.
+ * @param bb The position to evaluate
+ * @param side The side to move (TealMan or PurpleMan)
+ * @param material materialScore() of bb
+ * @param weights The weights to use
+ * @return Score from the side to move's perspective
+ */
+int evaluateWithMaterial(const Bitboard &bb, Piece side, int material, const EvalWeights &weights) {
+    int mobility = countSimpleMoves<Side::Teal>(bb) - countSimpleMoves<Side::Purple>(bb);
+    int tealScore = material + weights.mobility * mobility;
+    return (isTealPiece(side) ? tealScore : -tealScore) + weights.tempo;
+}
+
+/**
+ * @brief Evaluates a position from the perspective of the given side, from scratch.
+ * @param bb The position to evaluate
+ * @param side The piece type of the side to evaluate for (TealMan or PurpleMan)
+ * @param weights The weights to use
+ * @return Positive value if the side is ahead, negative if it is behind
+ */
+int evaluatePosition(const Bitboard &bb, Piece side, const EvalWeights &weights) {
+    return evaluateWithMaterial(bb, side, materialScore(bb, weights), weights);
+}
@@ -1,6 +1,5 @@
 #include "GameLogic.h"
-
-#include <cmath>
+#include "Bitboard.h"
 
 /**
  * @brief Checks if the given row and column coordinates are within the board bounds.
@@ -56,78 +55,158 @@ void initBoard(GameState &state) {
 
 /**
  * @brief Applies a move if it is legal according to checkers rules.
- * Validates the move, performs captures if applicable, and handles kinging.
+ * The move is given by its source and final square; a multi-jump is played in full.
+ * Captures are mandatory, so a simple move is rejected while any capture is available.
+ * If several jump sequences share both squares the move is ambiguous and rejected;
+ * applyMovePath() tells them apart by their landing squares.
  * @param state The current game state (will be modified if move is valid)
  * @param sr Source row index (0-based)
  * @param sc Source column index (0-based)
  * @param tr Target row index (0-based)
  * @param tc Target column index (0-based)
  * @param wasCapture Output parameter set to true if a capture occurred, false otherwise
+ * @param played If not nullptr, receives the move that was played
  * @return true if the move was valid and applied, false if the move was invalid
  */
-bool applyMove(GameState &state, int sr, int sc, int tr, int tc, bool &wasCapture) {
+bool applyMove(GameState &state, int sr, int sc, int tr, int tc, bool &wasCapture, Move *played) {
     wasCapture = false;
 
     if (!inBounds(sr, sc) || !inBounds(tr, tc)) return false;
-    if (!isDarkSquare(tr, tc)) return false;        // must land on dark square
-    if (state.board[tr][tc] != Empty) return false; // target must be empty
+    if (!isDarkSquare(sr, sc) || !isDarkSquare(tr, tc)) return false; // must be dark squares
 
-    Piece piece = state.board[sr][sc];
-    if (piece == Empty) return false;
-
-    bool tealPiece = isTealPiece(piece);
-    bool purplePiece = isPurplePiece(piece);
-    if (!tealPiece && !purplePiece) return false;
-
-    int dr = tr - sr;
-    int dc = tc - sc;
-
-    bool isKing = (piece == TealKing || piece == PurpleKing);
-
-    // Allowed movement directions in terms of row delta
-    // Teal is at bottom, so it moves "up" (negative row direction, dr = -1)
-    // Purple is at top, so it moves "down" (positive row direction, dr = 1)
-    int forwardDir = tealPiece ? -1 : 1;
-    auto isAllowedDir = [&](int deltaRow) {
-        if (deltaRow == forwardDir) return true;
-        if (isKing && deltaRow == -forwardDir) return true;
-        return false;
-    };
-
-    // Simple move: one step diagonally in allowed directions
-    if (std::abs(dc) == 1 && std::abs(dr) == 1 && isAllowedDir(dr)) {
-        state.board[tr][tc] = piece;
-        state.board[sr][sc] = Empty;
-    } else if (std::abs(dc) == 2 && std::abs(dr) == 2 && isAllowedDir(dr / 2)) {
-        // Capture move: two steps diagonally, jumping over opponent
-        int mr = sr + dr / 2;
-        int mc = sc + dc / 2;
-        if (!inBounds(mr, mc)) return false;
-        Piece mid = state.board[mr][mc];
-        if (mid == Empty) return false;
-
-        if ((tealPiece && !isPurplePiece(mid)) || (purplePiece && !isTealPiece(mid))) {
-            return false; // must capture opponent
+    int to = squareIndex(tr, tc);
+    return applyMovePath(state, squareIndex(sr, sc), &to, 1, wasCapture, played) == PathMatch::Played;
+}
+
+/**
+ * @brief Applies the legal move of a piece that lands on the given squares.
+ * The squares are the ones the piece lands on in order, as the player clicks them.
+ * The last square may also be the final square of a jump sequence whose earlier
+ * landings are not given, as long as only one sequence ends there and none passes
+ * through it; two sequences with the same source and final square capture
+ * different pieces and need every landing.
+ * Captures are mandatory, so a simple move is rejected while any capture is available.
+ * @param state The current game state (will be modified if a move is played)
+ * @param from Packed source square
+ * @param landings Packed landing squares in order (see Move::path)
+ * @param count Number of landing squares, at least 1
+ * @param wasCapture Output parameter set to true if a capture was played, false otherwise
+ * @param played If not nullptr, receives the move that was played
+ * @return How the squares match; the state only changes on PathMatch::Played
+ */
+PathMatch applyMovePath(GameState &state, int from, const int *landings, int count, bool &wasCapture,
+                        Move *played) {
+    wasCapture = false;
+    if (count < 1 || count > MAX_JUMPS) return PathMatch::Illegal;
+
+    Piece piece = state.board[squareRow(from)][squareCol(from)];
+    if (piece == Empty) return PathMatch::Illegal;
+
+    MoveList moves;
+    generateMoves(state, piece, moves);
+    const Move *exact = nullptr;     // lands on exactly the given squares
+    const Move *endsHere = nullptr;  // a sequence ending on the last square, earlier landings skipped
+    int endsHereCount = 0;
+    bool continues = false;          // some sequence lands on every given square and goes on
+    for (const Move &m : moves) {
+        if (m.from != from) continue;
+        // A simple move lands once, on its target.
+        int length = m.jumps > 0 ? m.jumps : 1;
+        auto landing = [&m](int i) { return m.jumps > 0 ? m.path[i] : m.to; };
+
+        int same = 0;
+        while (same < count - 1 && same < length && landing(same) == landings[same]) ++same;
+        if (same < count - 1) continue;
+        if (length >= count && landing(count - 1) == landings[count - 1]) {
+            if (length == count) {
+                exact = &m;
+            } else {
+                continues = true;
+            }
         }
+        if (m.to == landings[count - 1]) {
+            endsHere = &m;
+            ++endsHereCount;
+        }
+    }
 
-        state.board[mr][mc] = Empty;
-        state.board[tr][tc] = piece;
-        state.board[sr][sc] = Empty;
-        wasCapture = true;
-    } else {
-        return false;
+    // A square that another sequence passes through is taken as a landing along the way.
+    const Move *chosen = exact;
+    if (!chosen) {
+        if (continues) return PathMatch::Partial;
+        if (endsHereCount > 1) return PathMatch::Ambiguous;
+        if (endsHereCount == 0) return PathMatch::Illegal;
+        chosen = endsHere;
+    }
+    Move move = *chosen;
+    makeMove(state, move);
+    wasCapture = move.isCapture();
+    if (played) *played = move;
+    return PathMatch::Played;
+}
+
+/**
+ * @brief Plays a move in place without validating it.
+ * The move must come from generateMoves() for the current position.
+ * @param state The game state to modify
+ * @param move The legal move to play
+ * @return The record needed to take the move back with unmakeMove()
+ */
+UndoRecord makeMove(GameState &state, const Move &move) {
+    UndoRecord undo;
+    int sr = squareRow(move.from), sc = squareCol(move.from);
+    int tr = squareRow(move.to), tc = squareCol(move.to);
+
+    Piece piece = state.board[sr][sc];
+    state.board[sr][sc] = Empty;
+
+    for (std::uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        int sq = lowestSquare(captured);
+        Piece &victim = state.board[squareRow(sq)][squareCol(sq)];
+        if (victim == TealKing || victim == PurpleKing) {
+            undo.capturedKings |= squareBit(sq);
+        }
+        victim = Empty;
     }
 
     // Handle kinging
-    // Teal is at bottom, so it kings when reaching the top (row 0)
     if (piece == TealMan && tr == 0) {
-        state.board[tr][tc] = TealKing;
+        piece = TealKing;
+        undo.promoted = true;
     } else if (piece == PurpleMan && tr == BOARD_SIZE - 1) {
-        // Purple is at top, so it kings when reaching the bottom (row 7)
-        state.board[tr][tc] = PurpleKing;
+        piece = PurpleKing;
+        undo.promoted = true;
     }
 
-    return true;
+    state.board[tr][tc] = piece;
+    return undo;
+}
+
+/**
+ * @brief Takes back a move played with makeMove(), restoring the previous board exactly.
+ * @param state The game state to restore
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+void unmakeMove(GameState &state, const Move &move, const UndoRecord &undo) {
+    int sr = squareRow(move.from), sc = squareCol(move.from);
+    int tr = squareRow(move.to), tc = squareCol(move.to);
+
+    Piece piece = state.board[tr][tc];
+    if (undo.promoted) {
+        piece = (piece == TealKing) ? TealMan : PurpleMan;
+    }
+    state.board[tr][tc] = Empty;
+    state.board[sr][sc] = piece;
+
+    // Captured pieces belong to the other side.
+    bool tealMoved = isTealPiece(piece);
+    for (std::uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        int sq = lowestSquare(captured);
+        bool king = (undo.capturedKings & squareBit(sq)) != 0;
+        state.board[squareRow(sq)][squareCol(sq)] =
+            tealMoved ? (king ? PurpleKing : PurpleMan) : (king ? TealKing : TealMan);
+    }
 }
 
 /**
@@ -148,6 +227,17 @@ void countPieces(const GameState &state, int &tealCount, int &purpleCount) {
     }
 }
 
+/**
+ * @brief Generates all legal moves for one player without copying the board.
+ * Captures are mandatory and are generated as complete jump sequences.
+ * @param state The current game state
+ * @param side The piece type representing the player (TealMan, PurpleMan, TealKing, or PurpleKing)
+ * @param moves Output list, cleared and then filled with every legal move
+ */
+void generateMoves(const GameState &state, Piece side, MoveList &moves) {
+    generateMoves(toBitboard(state), side, moves);
+}
+
 /**
  * @brief Checks if the given player has at least one legal move available.
  * @param state The current game state
@@ -155,47 +245,5 @@ void countPieces(const GameState &state, int &tealCount, int &purpleCount) {
  * @return true if the player has at least one legal move, false otherwise
  */
 bool hasAnyMoves(const GameState &state, Piece player) {
-    bool lookTeal = isTealPiece(player);
-    bool lookPurple = isPurplePiece(player);
-
-    for (int r = 0; r < BOARD_SIZE; ++r) {
-        for (int c = 0; c < BOARD_SIZE; ++c) {
-            Piece piece = state.board[r][c];
-            if (piece == Empty) continue;
-            if (lookTeal && !isTealPiece(piece)) continue;
-            if (lookPurple && !isPurplePiece(piece)) continue;
-
-            bool tealPiece = isTealPiece(piece);
-            // Teal is at bottom, so it moves "up" (negative row direction, dr = -1)
-            // Purple is at top, so it moves "down" (positive row direction, dr = 1)
-            int forwardDir = tealPiece ? -1 : 1;
-            bool isKing = (piece == TealKing || piece == PurpleKing);
-
-            for (int dc = -2; dc <= 2; ++dc) {
-                if (dc == 0) continue;
-                for (int step = 1; step <= 2; ++step) {
-                    int dr = step;
-                    for (int dirSign : {1, -1}) {
-                        int actualDr = dr * dirSign;
-                        // Non-king pieces cannot move backwards
-                        if (!isKing) {
-                            if (actualDr != forwardDir && actualDr != 2 * forwardDir)
-                                continue;
-                        }
-                        int tr = r + actualDr;
-                        int tc = c + (dc > 0 ? step : -step);
-
-                        bool dummyCapture = false;
-                        GameState tmp = state;
-                        if (applyMove(tmp, r, c, tr, tc, dummyCapture)) {
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return false;
+    return hasAnyMoves(toBitboard(state), player);
 }
-
-
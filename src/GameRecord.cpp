@@ -0,0 +1,380 @@
+#include "GameRecord.h"
+#include "GameLogic.h"
+#include "Notation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr std::uint8_t CAPTURE_FLAG = 0x80;
+constexpr int GAME_HEADER_BYTES = 5;  ///< Outcome, ply count and byte count of a game
+constexpr int MORE_FOLLOWS = 3;       ///< Continuation byte count meaning "another byte follows"
+
+/**
+ * @brief Gets the direction of a diagonal step between two squares.
+ * @return 0 = up-left, 1 = up-right, 2 = down-left, 3 = down-right
+ */
+int stepDirection(int from, int to) {
+    int down = squareRow(to) > squareRow(from) ? 2 : 0;
+    int right = squareCol(to) > squareCol(from) ? 1 : 0;
+    return down | right;
+}
+
+/**
+ * @brief Finds the square a diagonal step of the given length leads to.
+ * @param from Source square
+ * @param direction 0 = up-left, 1 = up-right, 2 = down-left, 3 = down-right
+ * @param distance 1 for a simple move, 2 for a jump
+ * @return The target square, or -1 if the step leaves the board
+ */
+int stepTarget(int from, int direction, int distance) {
+    int r = squareRow(from) + ((direction & 2) ? distance : -distance);
+    int c = squareCol(from) + ((direction & 1) ? distance : -distance);
+    return inBounds(r, c) ? squareIndex(r, c) : -1;
+}
+
+/**
+ * @brief Adds a jump to a move being decoded.
+ * @return false if the jump leaves the board or the sequence is too long
+ */
+bool addJump(Move &move, int direction) {
+    if (move.jumps >= MAX_JUMPS) return false;
+    int from = move.jumps == 0 ? move.from : move.path[move.jumps - 1];
+    int to = stepTarget(from, direction, 2);
+    if (to < 0) return false;
+    move.captured |= squareBit(stepTarget(from, direction, 1));
+    move.path[move.jumps++] = static_cast<std::uint8_t>(to);
+    move.to = static_cast<std::uint8_t>(to);
+    return true;
+}
+
+bool sameMove(const Move &a, const Move &b) {
+    return a.from == b.from && a.to == b.to && a.jumps == b.jumps && a.captured == b.captured &&
+           std::equal(a.path.begin(), a.path.begin() + a.jumps, b.path.begin());
+}
+
+void putUint16(std::uint8_t *out, unsigned value) {
+    out[0] = static_cast<std::uint8_t>(value & 0xFF);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+}
+
+unsigned getUint16(const std::uint8_t *in) {
+    return in[0] | (in[1] << 8);
+}
+
+const char *pdnResult(GameOutcome outcome) {
+    switch (outcome) {
+        case GameOutcome::TealWin: return "1-0";
+        case GameOutcome::PurpleWin: return "0-1";
+        case GameOutcome::Draw: return "1/2-1/2";
+        case GameOutcome::Unfinished: break;
+    }
+    return "*";
+}
+
+} // namespace
+
+/**
+ * @brief Encodes a move in the compact record format.
+ * @param move A move from generateMoves()
+ * @param out Buffer of at least MAX_ENCODED_MOVE bytes
+ * @return Number of bytes written
+ */
+int encodeMove(const Move &move, std::uint8_t *out) {
+    if (!move.isCapture()) {
+        out[0] = static_cast<std::uint8_t>(stepDirection(move.from, move.to) << 5 | move.from);
+        return 1;
+    }
+
+    out[0] = static_cast<std::uint8_t>(CAPTURE_FLAG | stepDirection(move.from, move.path[0]) << 5 | move.from);
+    int length = 1;
+    int jump = 1;
+    for (;;) {
+        int inByte = std::min(MORE_FOLLOWS, move.jumps - jump);
+        std::uint8_t byte = 0;
+        for (int i = 0; i < inByte; ++i, ++jump) {
+            byte |= static_cast<std::uint8_t>(stepDirection(move.path[jump - 1], move.path[jump]) << (2 * i));
+        }
+        // Three directions fill the byte, so that count also says another byte follows.
+        out[length++] = static_cast<std::uint8_t>(inByte << 6 | byte);
+        if (inByte < MORE_FOLLOWS) break;
+    }
+    return length;
+}
+
+/**
+ * @brief Decodes one move of the compact record format.
+ * The move is rebuilt from its squares alone; replaying it is only valid if it is
+ * legal in the position it is played in.
+ * @param in The encoded bytes
+ * @param available Number of bytes readable at in
+ * @param move Output parameter for the move
+ * @return Number of bytes read, 0 if the bytes are not a valid move
+ */
+int decodeMove(const std::uint8_t *in, std::size_t available, Move &move) {
+    if (available == 0) return 0;
+    move = Move{};
+    move.from = in[0] & 0x1F;
+    int direction = (in[0] >> 5) & 3;
+
+    if (!(in[0] & CAPTURE_FLAG)) {
+        int to = stepTarget(move.from, direction, 1);
+        if (to < 0) return 0;
+        move.to = static_cast<std::uint8_t>(to);
+        return 1;
+    }
+
+    if (!addJump(move, direction)) return 0;
+    std::size_t length = 1;
+    for (;;) {
+        if (length >= available) return 0;
+        std::uint8_t byte = in[length++];
+        int inByte = byte >> 6;
+        for (int i = 0; i < inByte; ++i) {
+            if (!addJump(move, (byte >> (2 * i)) & 3)) return 0;
+        }
+        if (inByte < MORE_FOLLOWS) break;
+    }
+    return static_cast<int>(length);
+}
+
+/**
+ * @brief Forgets all moves and the outcome, e.g. before a new game.
+ */
+void GameRecord::clear() {
+    data.clear();
+    plies = 0;
+    result = GameOutcome::Unfinished;
+}
+
+/**
+ * @brief Appends the next move of the game.
+ * @param move The move played, from generateMoves() for the current position
+ */
+void GameRecord::append(const Move &move) {
+    std::uint8_t encoded[MAX_ENCODED_MOVE];
+    int length = encodeMove(move, encoded);
+    data.insert(data.end(), encoded, encoded + length);
+    ++plies;
+}
+
+/**
+ * @brief Replaces the record with encoded moves, e.g. ones read from a file.
+ * @param bytes The move bytes
+ * @param plyCount Number of moves they hold
+ * @param outcome How the game ended
+ */
+void GameRecord::assign(std::vector<std::uint8_t> bytes, int plyCount, GameOutcome outcome) {
+    data = std::move(bytes);
+    plies = plyCount;
+    result = outcome;
+}
+
+/**
+ * @brief Decodes every move.
+ * @param moves Output parameter receiving the moves in playing order
+ * @return true if all bytes decoded into exactly plyCount() moves
+ */
+bool GameRecord::decode(std::vector<Move> &moves) const {
+    moves.clear();
+    moves.reserve(plies);
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        Move move;
+        int length = decodeMove(data.data() + offset, data.size() - offset, move);
+        if (length == 0) return false;
+        offset += length;
+        moves.push_back(move);
+    }
+    return static_cast<int>(moves.size()) == plies;
+}
+
+/**
+ * @brief Opens a file for appending, writing its header if it is new or empty.
+ * @param path The file to append to
+ * @return true if the file is open, false if it cannot be written or is not a
+ * record file for the current rules
+ */
+bool GameRecordWriter::open(const std::string &path) {
+    out.close();
+
+    // An existing file must be one of ours, or the appended games would be unreadable.
+    std::ifstream existing(path, std::ios::binary);
+    GameFileHeader header{};
+    bool hasHeader = existing && existing.read(reinterpret_cast<char *>(&header), sizeof(header));
+    bool isEmpty = !hasHeader && existing.gcount() == 0;
+    if ((!hasHeader && !isEmpty) ||
+        (hasHeader && (std::memcmp(header.magic, GAME_MAGIC, sizeof(GAME_MAGIC)) != 0 ||
+                       header.rulesVersion != RULES_VERSION))) {
+        std::cerr << path << " is not a game record file for the current rules\n";
+        return false;
+    }
+    existing.close();
+
+    out.open(path, std::ios::binary | std::ios::app);
+    if (!out) {
+        return false;
+    }
+    if (!hasHeader) {
+        header = GameFileHeader{};
+        std::memcpy(header.magic, GAME_MAGIC, sizeof(GAME_MAGIC));
+        header.rulesVersion = RULES_VERSION;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Appends a game.
+ * @param record The game to write
+ * @return true if it was written, false on an I/O error
+ */
+bool GameRecordWriter::write(const GameRecord &record) {
+    if (record.plyCount() > 0xFFFF || record.bytes().size() > 0xFFFF) {
+        std::cerr << "Game of " << record.plyCount() << " plies is too long to record\n";
+        return false;
+    }
+    std::uint8_t header[GAME_HEADER_BYTES];
+    header[0] = static_cast<std::uint8_t>(record.outcome());
+    putUint16(header + 1, static_cast<unsigned>(record.plyCount()));
+    putUint16(header + 3, static_cast<unsigned>(record.bytes().size()));
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(record.bytes().data()),
+              static_cast<std::streamsize>(record.bytes().size()));
+    // Flush per game so a crash loses at most the game being written.
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Maps a record file, closing any previously opened one.
+ * @param path Path of a file written by GameRecordWriter
+ * @return true if the file was mapped and is valid for the current rules
+ */
+bool GameRecordReader::open(const std::string &path) {
+    offset = 0;
+    if (!openDataFile(file, path, GAME_MAGIC, sizeof(GameFileHeader), "Game record file",
+                      "record new games with checkers_selfplay --record")) {
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+/**
+ * @brief Reads the next game.
+ * @param record Output parameter for the game
+ * @return true if a game was read, false at the end of the file
+ */
+bool GameRecordReader::next(GameRecord &record) {
+    if (!file.isOpen() || offset + GAME_HEADER_BYTES > file.size()) {
+        return false;
+    }
+    const std::uint8_t *header = file.data() + offset;
+    std::size_t length = getUint16(header + 3);
+    if (offset + GAME_HEADER_BYTES + length > file.size() || header[0] > 3) {
+        std::cerr << "Game record file ends in a truncated or corrupt game\n";
+        offset = file.size();
+        return false;
+    }
+    const std::uint8_t *moves = header + GAME_HEADER_BYTES;
+    record.assign(std::vector<std::uint8_t>(moves, moves + length), static_cast<int>(getUint16(header + 1)),
+                  static_cast<GameOutcome>(header[0]));
+    offset += GAME_HEADER_BYTES + length;
+    return true;
+}
+
+/**
+ * @brief Decodes a game and checks every move is legal; the replay starts at ply 0.
+ * @param record The game to replay
+ * @return true if the game is valid, false if a move is corrupt or illegal
+ */
+bool GameReplay::load(const GameRecord &record) {
+    GameState start;
+    initBoard(start);
+    bb = toBitboard(start);
+    current = 0;
+    undos.clear();
+
+    if (!record.decode(moves)) {
+        moves.clear();
+        return false;
+    }
+    undos.reserve(moves.size());
+
+    // Play the game through once to check it, then take it all back.
+    MoveList legal;
+    bool valid = true;
+    for (const Move &move : moves) {
+        generateMoves(bb, sideToMove(), legal);
+        if (std::none_of(legal.begin(), legal.end(), [&](const Move &m) { return sameMove(m, move); })) {
+            valid = false;
+            break;
+        }
+        undos.push_back(makeMove(bb, move));
+        ++current;
+    }
+    seek(0);
+    if (!valid) {
+        moves.clear();
+    }
+    return valid;
+}
+
+/**
+ * @brief Moves to a ply by playing or taking back moves from the current one.
+ * @param ply Target ply, clamped to [0, plyCount()]
+ */
+void GameReplay::seek(int ply) {
+    ply = std::max(0, std::min(ply, plyCount()));
+    while (current > ply) {
+        --current;
+        unmakeMove(bb, moves[current], undos.back());
+        undos.pop_back();
+    }
+    while (current < ply) {
+        undos.push_back(makeMove(bb, moves[current]));
+        ++current;
+    }
+}
+
+/**
+ * @brief Formats a game as PDN text with its tags and numbered moves.
+ * Teal is Black and moves first; "1-0" is a Teal win.
+ * @param record The game
+ * @param event Value of the Event tag
+ * @param round Value of the Round tag, e.g. the game's number
+ * @return The PDN game, ending with a blank line
+ */
+std::string toPdn(const GameRecord &record, const std::string &event, const std::string &round) {
+    const char *result = pdnResult(record.outcome());
+    std::string text = "[Event \"" + event + "\"]\n[Round \"" + round + "\"]\n"
+                       "[Black \"Teal\"]\n[White \"Purple\"]\n[Result \"" + result + "\"]\n"
+                       "[GameType \"21\"]\n";
+
+    std::vector<Move> moves;
+    if (!record.decode(moves)) {
+        moves.clear();
+        text += "{corrupt record}\n";
+    }
+
+    // Movetext wrapped at 80 columns, as PDN readers expect.
+    std::string line;
+    auto addToken = [&](const std::string &token) {
+        if (!line.empty() && line.size() + 1 + token.size() > 80) {
+            text += line + "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    };
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        // A move number stays on the line of the move it numbers.
+        std::string number = i % 2 == 0 ? std::to_string(i / 2 + 1) + ". " : "";
+        addToken(number + moveToString(moves[i]));
+    }
+    addToken(result);
+    text += line + "\n\n";
+    return text;
+}
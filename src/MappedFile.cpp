@@ -0,0 +1,143 @@
+#include "MappedFile.h"
+#include "GameLogic.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Unmaps the file if one is open.
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * @brief Maps a file, unmapping any previously opened one.
+ * @param path Path of the file to map
+ * @return true if the file was mapped, false if it is missing, empty or cannot be mapped
+ */
+bool MappedFile::open(const std::string &path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    bytes = static_cast<const unsigned char *>(view);
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive, so the descriptor is not needed any more.
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    // Probes jump around the file, so read-ahead would only waste I/O.
+    madvise(view, static_cast<std::size_t>(info.st_size), MADV_RANDOM);
+    bytes = static_cast<const unsigned char *>(view);
+    length = static_cast<std::size_t>(info.st_size);
+#endif
+    return true;
+}
+
+/**
+ * @brief Unmaps the file. Pointers obtained from data() become invalid.
+ */
+void MappedFile::close() {
+    if (!bytes) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(bytes);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char *>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+/**
+ * @brief Maps one of the game's data files and checks its header.
+ * The header must start with an 8-byte magic followed by the RULES_VERSION the
+ * file was written for. Problems are reported on stderr, prefixed with the
+ * description, and leave the file closed; a stale file gets the rebuild hint.
+ * @param file Mapping to open, closing any previously opened file
+ * @param path Path of the file to map
+ * @param magic Expected first 8 bytes of the file
+ * @param headerSize Size of the whole header in bytes
+ * @param description Kind of file for messages, e.g. "Opening book"
+ * @param rebuildHint How to replace a file written for other rules, e.g.
+ * "rebuild it with checkers_selfplay --book-out"
+ * @return true if the file was mapped, is at least headerSize bytes long and was
+ * written with magic for the current rules
+ */
+bool openDataFile(MappedFile &file, const std::string &path, const char (&magic)[8], std::size_t headerSize,
+                  const char *description, const char *rebuildHint) {
+    if (!file.open(path)) {
+        return false;
+    }
+    if (file.size() < headerSize || file.size() < sizeof(magic) + sizeof(std::uint32_t)) {
+        std::cerr << description << " " << path << " is truncated\n";
+        file.close();
+        return false;
+    }
+    if (std::memcmp(file.data(), magic, sizeof(magic)) != 0) {
+        std::cerr << description << " " << path << " has an unknown format\n";
+        file.close();
+        return false;
+    }
+    std::uint32_t rulesVersion;
+    std::memcpy(&rulesVersion, file.data() + sizeof(magic), sizeof(rulesVersion));
+    if (rulesVersion != RULES_VERSION) {
+        std::cerr << description << " " << path << " was written for rules version " << rulesVersion
+                  << ", expected " << RULES_VERSION << "; " << rebuildHint << "\n";
+        file.close();
+        return false;
+    }
+    return true;
+}
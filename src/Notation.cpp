@@ -0,0 +1,184 @@
+#include "Notation.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> split(const std::string &text, char separator) {
+    std::vector<std::string> parts;
+    std::string part;
+    std::istringstream in(text);
+    while (std::getline(in, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+std::string trim(const std::string &text) {
+    std::size_t begin = 0, end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) ++begin;
+    while (end > begin && (std::isspace(static_cast<unsigned char>(text[end - 1])) || text[end - 1] == '.')) --end;
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * @brief Parses a PDN square number, rejecting anything outside [1, 32].
+ */
+bool parseSquareNumber(const std::string &text, int &n) {
+    if (text.empty()) return false;
+    for (char ch : text) {
+        if (!std::isdigit(static_cast<unsigned char>(ch))) return false;
+    }
+    n = std::atoi(text.c_str());
+    return n >= 1 && n <= NUM_SQUARES;
+}
+
+/**
+ * @brief Adds one colour's square list ("K3,5,9-12") to the position.
+ */
+bool parsePieceList(const std::string &list, bool teal, Bitboard &bb) {
+    for (std::string item : split(list, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+
+        bool king = (item[0] == 'K' || item[0] == 'k');
+        if (king) item.erase(0, 1);
+
+        int first = 0, last = 0;
+        std::size_t dash = item.find('-');
+        if (dash == std::string::npos) {
+            if (!parseSquareNumber(item, first)) return false;
+            last = first;
+        } else if (!parseSquareNumber(item.substr(0, dash), first) ||
+                   !parseSquareNumber(item.substr(dash + 1), last) || last < first) {
+            return false;
+        }
+
+        for (int n = first; n <= last; ++n) {
+            std::uint32_t bit = squareBit(pdnToSquare(n));
+            if ((bb.teal | bb.purple) & bit) return false; // square listed twice
+            (teal ? bb.teal : bb.purple) |= bit;
+            if (king) bb.kings |= bit;
+        }
+    }
+    return true;
+}
+
+void appendPieceList(std::ostringstream &out, std::uint32_t pieces, std::uint32_t kings) {
+    bool first = true;
+    for (int n = 1; n <= NUM_SQUARES; ++n) {
+        std::uint32_t bit = squareBit(pdnToSquare(n));
+        if (!(pieces & bit)) continue;
+        if (!first) out << ',';
+        if (kings & bit) out << 'K';
+        out << n;
+        first = false;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Parses a PDN FEN string such as "B:W18,24,K27:B12,16".
+ * Square lists may contain ranges ("1-12") and a 'K' prefix marks a king.
+ * @param fen The FEN string to parse
+ * @param bb Output parameter for the position
+ * @param side Output parameter for the side to move (TealMan or PurpleMan)
+ * @return true if the string was a valid FEN, false otherwise
+ */
+bool parseFen(const std::string &fen, Bitboard &bb, Piece &side) {
+    std::vector<std::string> fields = split(trim(fen), ':');
+    if (fields.empty()) return false;
+
+    std::string turn = trim(fields[0]);
+    if (turn == "B" || turn == "b") side = TealMan;
+    else if (turn == "W" || turn == "w") side = PurpleMan;
+    else return false;
+
+    Bitboard parsed;
+    for (std::size_t i = 1; i < fields.size(); ++i) {
+        std::string field = trim(fields[i]);
+        if (field.empty()) continue;
+        char colour = static_cast<char>(std::toupper(static_cast<unsigned char>(field[0])));
+        if (colour != 'B' && colour != 'W') return false;
+        if (!parsePieceList(field.substr(1), colour == 'B', parsed)) return false;
+    }
+
+    bb = parsed;
+    return true;
+}
+
+/**
+ * @brief Formats a position as a PDN FEN string.
+ * @param bb The position to format
+ * @param side The side to move (TealMan or PurpleMan)
+ * @return The FEN string, with squares in ascending order
+ */
+std::string toFen(const Bitboard &bb, Piece side) {
+    std::ostringstream out;
+    out << (isTealPiece(side) ? 'B' : 'W') << ":W";
+    appendPieceList(out, bb.purple, bb.kings);
+    out << ":B";
+    appendPieceList(out, bb.teal, bb.kings);
+    return out.str();
+}
+
+/**
+ * @brief Formats a move in PDN style, e.g. "11-15", "15x24", or "1x10x19" for a multi-jump.
+ * @param move The move to format
+ * @return The move text
+ */
+std::string moveToString(const Move &move) {
+    if (!move.isCapture()) {
+        return std::to_string(squareToPdn(move.from)) + "-" + std::to_string(squareToPdn(move.to));
+    }
+    std::string text = std::to_string(squareToPdn(move.from));
+    for (int i = 0; i < move.jumps; ++i) {
+        text += "x" + std::to_string(squareToPdn(move.path[i]));
+    }
+    return text;
+}
+
+/**
+ * @brief Finds the legal move written in PDN style, e.g. "11-15", "15x24" or "1x10x19".
+ * A multi-jump may be written with every landing square or with its end squares
+ * alone ("1x19"), as long as only one jump sequence joins them.
+ * @param text The move text
+ * @param legal The legal moves of the position, from generateMoves()
+ * @param move Output parameter for the matching move
+ * @return true if the text names exactly one legal move, false otherwise
+ */
+bool parseMove(const std::string &text, const MoveList &legal, Move &move) {
+    // Squares joined by '-' for a simple move or 'x' for a capture.
+    std::string body = trim(text);
+    bool capture = body.find('x') != std::string::npos;
+    if (capture && body.find('-') != std::string::npos) return false;
+    std::vector<int> squares;
+    for (const std::string &part : split(body, capture ? 'x' : '-')) {
+        int n;
+        if (!parseSquareNumber(part, n)) return false;
+        squares.push_back(pdnToSquare(n));
+    }
+    if (squares.size() < 2 || (!capture && squares.size() != 2)) return false;
+
+    int matches = 0;
+    for (const Move &m : legal) {
+        if (m.isCapture() != capture || m.from != squares.front() || m.to != squares.back()) continue;
+        if (squares.size() > 2) {
+            if (m.jumps != static_cast<int>(squares.size()) - 1) continue;
+            bool samePath = true;
+            for (int i = 0; i < m.jumps; ++i) {
+                samePath = samePath && m.path[i] == squares[i + 1];
+            }
+            if (!samePath) continue;
+        }
+        // Sequences that take the same pieces have the same effect.
+        if (matches > 0 && m.captured == move.captured) continue;
+        move = m;
+        ++matches;
+    }
+    return matches == 1;
+}
@@ -0,0 +1,142 @@
+#include "OpeningBook.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+bool entryLess(const BookEntry &a, const BookEntry &b) {
+    if (a.key != b.key) return a.key < b.key;
+    return a.weight > b.weight; // heaviest move of a position first
+}
+
+} // namespace
+
+/**
+ * @brief Sorts book entries and writes them as a book file.
+ * @param path Output file
+ * @param entries The entries to write; sorted in place
+ * @return true if the file was written, false on an I/O error
+ */
+bool writeOpeningBook(const std::string &path, std::vector<BookEntry> &entries) {
+    std::sort(entries.begin(), entries.end(), entryLess);
+
+    BookFileHeader header{};
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.rulesVersion = RULES_VERSION;
+    header.entryCount = entries.size();
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(BookEntry)));
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Maps a book file, closing any previously opened one.
+ * @param path Path of a file written by writeOpeningBook()
+ * @return true if the file was mapped and is valid for the current rules
+ */
+bool OpeningBook::open(const std::string &path) {
+    close();
+    if (!openDataFile(file, path, BOOK_MAGIC, sizeof(BookFileHeader), "Opening book",
+                      "rebuild it with checkers_selfplay --book-out")) {
+        return false;
+    }
+
+    BookFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (file.size() < sizeof(header) + header.entryCount * sizeof(BookEntry)) {
+        std::cerr << "Opening book " << path << " is truncated\n";
+        close();
+        return false;
+    }
+
+    // The header is 8-byte aligned and the mapping page aligned, so the records can
+    // be used in place.
+    entries = reinterpret_cast<const BookEntry *>(file.data() + sizeof(header));
+    count = header.entryCount;
+    return true;
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+void OpeningBook::close() {
+    file.close();
+    entries = nullptr;
+    count = 0;
+}
+
+/**
+ * @brief Finds the book entries of a position.
+ * @param key Zobrist key of the position
+ * @param first Output parameter for the first matching entry
+ * @return Number of entries for the position, 0 if it is not in the book
+ */
+int OpeningBook::find(std::uint64_t key, const BookEntry *&first) const {
+    const BookEntry *end = entries + count;
+    auto byKey = [](const BookEntry &e, std::uint64_t k) { return e.key < k; };
+    first = std::lower_bound(entries, end, key, byKey);
+    const BookEntry *last = first;
+    while (last != end && last->key == key) {
+        ++last;
+    }
+    return static_cast<int>(last - first);
+}
+
+/**
+ * @brief Picks a book move for a position, at random in proportion to the weights.
+ * Book moves that are not legal here (a hash collision) are ignored.
+ * @param bb The position
+ * @param side The side to move (TealMan or PurpleMan)
+ * @param legal The legal moves of the position
+ * @param rng Random source for the weighted choice
+ * @param move Output parameter for the chosen move
+ * @return true if the book had a move for the position, false otherwise
+ */
+bool OpeningBook::chooseMove(const Bitboard &bb, Piece side, const MoveList &legal, std::mt19937 &rng,
+                             Move &move) const {
+    if (!isOpen()) {
+        return false;
+    }
+    const BookEntry *first = nullptr;
+    int n = find(zobristKey(bb, side), first);
+
+    // Match each book move to a legal move so the caller gets full move details.
+    const Move *candidates[MAX_MOVES];
+    std::uint32_t weights[MAX_MOVES];
+    int found = 0;
+    std::uint32_t total = 0;
+    for (int i = 0; i < n && found < MAX_MOVES; ++i) {
+        for (const Move &m : legal) {
+            if (m.from == first[i].from && m.to == first[i].to && m.captured == first[i].captured &&
+                first[i].weight > 0) {
+                candidates[found] = &m;
+                weights[found] = first[i].weight;
+                total += first[i].weight;
+                ++found;
+                break;
+            }
+        }
+    }
+    if (found == 0) {
+        return false;
+    }
+
+    std::uniform_int_distribution<std::uint32_t> pick(0, total - 1);
+    std::uint32_t roll = pick(rng);
+    for (int i = 0; i < found; ++i) {
+        if (roll < weights[i]) {
+            move = *candidates[i];
+            return true;
+        }
+        roll -= weights[i];
+    }
+    move = *candidates[found - 1];
+    return true;
+}
@@ -0,0 +1,160 @@
+#include "Profiler.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief A timed scope ('X') or counter sample ('C') in Chrome trace terms.
+ */
+struct TraceEvent {
+    const char *name;
+    char phase;
+    int thread;
+    double startUs;  ///< Microseconds since the process started
+    double value;    ///< Duration in microseconds for scopes, the sample for counters
+};
+
+// Events beyond this are dropped so a long session cannot exhaust memory
+// (about an hour of a typical frame's events).
+constexpr std::size_t MAX_EVENTS = std::size_t{1} << 21;
+
+const Clock::time_point epoch = Clock::now();
+
+std::mutex eventMutex;
+std::vector<TraceEvent> events;
+std::uint64_t droppedEvents = 0;
+
+std::mutex frameMutex;
+std::array<float, PROFILE_FRAME_HISTORY> frameTimes{};
+int frameCount = 0;
+Clock::time_point lastFrame = epoch;
+
+double microsecondsSinceStart(Clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - epoch).count();
+}
+
+/**
+ * @brief Gets a small id for the calling thread, numbered in order of first use.
+ */
+int threadId() {
+    static std::atomic<int> nextId{0};
+    thread_local int id = nextId++;
+    return id;
+}
+
+void record(const TraceEvent &event) {
+    std::lock_guard<std::mutex> lock(eventMutex);
+    if (events.size() >= MAX_EVENTS) {
+        ++droppedEvents;
+        return;
+    }
+    events.push_back(event);
+}
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ */
+void writeJsonString(std::ostream &out, const char *text) {
+    out << '"';
+    for (const char *p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') out << '\\';
+        out << *p;
+    }
+    out << '"';
+}
+
+} // namespace
+
+/**
+ * @brief Stops timing and records the event.
+ */
+ProfileScope::~ProfileScope() {
+    Clock::time_point end = Clock::now();
+    double startUs = microsecondsSinceStart(start);
+    record({name, 'X', threadId(), startUs, microsecondsSinceStart(end) - startUs});
+}
+
+/**
+ * @brief Records a sample of a counter.
+ * @param name Counter name, a string literal
+ * @param value Current value
+ */
+void profileCounter(const char *name, double value) {
+    record({name, 'C', threadId(), microsecondsSinceStart(Clock::now()), value});
+}
+
+/**
+ * @brief Marks the end of a frame, recording the time since the previous mark.
+ */
+void profileFrame() {
+    Clock::time_point now = Clock::now();
+    float ms;
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        ms = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+        lastFrame = now;
+        frameTimes[frameCount % PROFILE_FRAME_HISTORY] = ms;
+        ++frameCount;
+    }
+    profileCounter("frame_ms", ms);
+}
+
+/**
+ * @brief Copies the most recent frame times, oldest first.
+ * @param out Array receiving up to PROFILE_FRAME_HISTORY times in milliseconds
+ * @return Number of times copied
+ */
+int recentFrameTimes(float *out) {
+    std::lock_guard<std::mutex> lock(frameMutex);
+    int count = frameCount < PROFILE_FRAME_HISTORY ? frameCount : PROFILE_FRAME_HISTORY;
+    for (int i = 0; i < count; ++i) {
+        out[i] = frameTimes[(frameCount - count + i) % PROFILE_FRAME_HISTORY];
+    }
+    return count;
+}
+
+/**
+ * @brief Writes every recorded event as Chrome trace-event JSON.
+ * @param path File to write
+ * @return true if the file was written, false on an I/O error
+ */
+bool writeChromeTrace(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(eventMutex);
+    if (droppedEvents > 0) {
+        std::cerr << "Profiler: " << droppedEvents << " events beyond the first " << MAX_EVENTS
+                  << " were dropped\n";
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    char numbers[96];
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent &e = events[i];
+        out << (i ? ",\n" : "") << "{\"name\": ";
+        writeJsonString(out, e.name);
+        if (e.phase == 'X') {
+            std::snprintf(numbers, sizeof(numbers), "\"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f",
+                          e.startUs, e.value);
+            out << ", " << numbers << ", \"pid\": 1, \"tid\": " << e.thread << "}";
+        } else {
+            std::snprintf(numbers, sizeof(numbers), "\"ph\": \"C\", \"ts\": %.3f", e.startUs);
+            out << ", " << numbers << ", \"pid\": 1, \"args\": {\"value\": " << e.value << "}}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -1,20 +1,349 @@
 #include "Renderer.h"
+#include "Notation.h"
+#include "Profiler.h"
+#include "StartupTimings.h"
+#include "raymath.h"
 #include "rlgl.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace {
+
+// Minimal GLSL 330 shaders for DrawMeshInstanced: each instance's model matrix arrives
+// as a vertex attribute. Colors are the mesh's vertex colors times the material color.
+// The second texture coordinate holds each vertex's distance to the two outlined edges
+// of its face (see MeshBuilder::edges); fragments closer than edgeWidth to either are
+// drawn black, which outlines the pieces without a separate wireframe pass.
+const char *const INSTANCING_VS = R"(#version 330
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec2 vertexTexCoord2;
+in vec4 vertexColor;
+in mat4 instanceTransform;
+uniform mat4 mvp;
+out vec2 fragTexCoord;
+out vec2 fragEdgeDistance;
+out vec4 fragColor;
+void main() {
+    fragTexCoord = vertexTexCoord;
+    fragEdgeDistance = vertexTexCoord2;
+    fragColor = vertexColor;
+    gl_Position = mvp * instanceTransform * vec4(vertexPosition, 1.0);
+}
+)";
+
+const char *const INSTANCING_FS = R"(#version 330
+in vec2 fragTexCoord;
+in vec2 fragEdgeDistance;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float edgeWidth;
+out vec4 finalColor;
+void main() {
+    vec4 color = texture(texture0, fragTexCoord) * colDiffuse * fragColor;
+    float distance = min(fragEdgeDistance.x, fragEdgeDistance.y);
+    float blur = fwidth(distance);
+    float outline = 1.0 - smoothstep(edgeWidth - blur, edgeWidth + blur, distance);
+    finalColor = vec4(mix(color.rgb, vec3(0.0), outline), color.a);
+}
+)";
+
+const Color DARK_SQUARE = (Color){118, 150, 86, 255};   // Dark green
+const Color LIGHT_SQUARE = (Color){238, 238, 210, 255}; // Light beige
+const Color TEAL_PIECE = (Color){0, 128, 128, 255};
+const Color PURPLE_PIECE = (Color){128, 0, 128, 255};
+const Color GOLD = (Color){255, 215, 0, 255};
+
+// Edge distances of a vertex on no outlined edge; far more than the outline width.
+const Vector2 NO_EDGE = {1.0f, 1.0f};
+const float EDGE_WIDTH = 0.02f;  ///< Width of the piece outlines in world units
+
+// Segments around a piece. The camera never moves closer or further, so a piece always
+// shows with a radius of 17 to 23 pixels; a 16-gon strays from the circle by
+// r(1 - cos(pi / 16)), under half a pixel at that size, so one mesh serves every square.
+constexpr int PIECE_SLICES = 16;
+
+/**
+ * @brief Collects triangles on the CPU and uploads them as one static mesh.
+ */
+struct MeshBuilder {
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<unsigned char> colors;
+    std::vector<float> edges;  ///< Per vertex, its distances to the two outlined edges of its face
+    std::vector<unsigned short> indices;
+
+    /**
+     * @brief Appends one vertex.
+     * @param position Position of the vertex
+     * @param normal Normal of the vertex
+     * @param color Vertex color
+     * @param edge Distances to the outlined edges of its face, NO_EDGE for none
+     * @return Index of the vertex
+     */
+    unsigned short addVertex(Vector3 position, Vector3 normal, Color color, Vector2 edge) {
+        auto index = static_cast<unsigned short>(vertices.size() / 3);
+        vertices.insert(vertices.end(), {position.x, position.y, position.z});
+        normals.insert(normals.end(), {normal.x, normal.y, normal.z});
+        colors.insert(colors.end(), {color.r, color.g, color.b, color.a});
+        edges.insert(edges.end(), {edge.x, edge.y});
+        return index;
+    }
+
+    /**
+     * @brief Adds a flat quad; its corners may be given in either winding order.
+     * @param corners The four corners, in order around the quad
+     * @param normal Direction the visible side faces
+     * @param color Vertex color of the quad
+     * @param edge Edge distances of each corner, none outlined by default
+     */
+    void addQuad(std::array<Vector3, 4> corners, Vector3 normal, Color color,
+                 std::array<Vector2, 4> edge = {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}) {
+        // Triangles must wind counter-clockwise seen from the front, or they are culled.
+        Vector3 faceNormal = Vector3CrossProduct(Vector3Subtract(corners[1], corners[0]),
+                                                 Vector3Subtract(corners[2], corners[0]));
+        if (Vector3DotProduct(faceNormal, normal) < 0.0f) {
+            std::swap(corners[1], corners[3]);
+            std::swap(edge[1], edge[3]);
+        }
+        unsigned short first = 0;
+        for (int i = 0; i < 4; ++i) {
+            unsigned short index = addVertex(corners[i], normal, color, edge[i]);
+            if (i == 0) first = index;
+        }
+        const unsigned short quad[6] = {0, 1, 2, 0, 2, 3};
+        for (unsigned short i : quad) {
+            indices.push_back(static_cast<unsigned short>(first + i));
+        }
+    }
+
+    /**
+     * @brief Adds an axis-aligned box.
+     * @param center Center of the box
+     * @param size Full extent along each axis
+     * @param color Vertex color of every face
+     */
+    void addBox(Vector3 center, Vector3 size, Color color) {
+        const Vector3 half = Vector3Scale(size, 0.5f);
+        const Vector3 axes[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        for (int a = 0; a < 3; ++a) {
+            const Vector3 &u = axes[(a + 1) % 3];
+            const Vector3 &v = axes[(a + 2) % 3];
+            for (float sign : {-1.0f, 1.0f}) {
+                Vector3 n = Vector3Scale(axes[a], sign);
+                std::array<Vector3, 4> corners;
+                const float su[4] = {-1, 1, 1, -1};
+                const float sv[4] = {-1, -1, 1, 1};
+                for (int i = 0; i < 4; ++i) {
+                    Vector3 offset = Vector3Add(n, Vector3Add(Vector3Scale(u, su[i]), Vector3Scale(v, sv[i])));
+                    corners[i] = Vector3Add(center, Vector3Multiply(offset, half));
+                }
+                addQuad(corners, n, color);
+            }
+        }
+    }
+
+    /**
+     * @brief Adds the outward-facing side of a vertical cylinder section, with its
+     * top and bottom edges outlined.
+     * @param radius Radius of the band
+     * @param bottom Height of its lower edge
+     * @param top Height of its upper edge
+     * @param slices Number of segments around the circumference
+     * @param color Vertex color of the band
+     */
+    void addBand(float radius, float bottom, float top, int slices, Color color) {
+        for (int i = 0; i < slices; ++i) {
+            float a0 = 2.0f * M_PI * i / slices;
+            float a1 = 2.0f * M_PI * (i + 1) / slices;
+            float mid = (a0 + a1) / 2.0f;
+            Vector3 p0 = {radius * std::cos(a0), bottom, radius * std::sin(a0)};
+            Vector3 p1 = {radius * std::cos(a1), bottom, radius * std::sin(a1)};
+            const float height = top - bottom;
+            addQuad({p0, p1, (Vector3){p1.x, top, p1.z}, (Vector3){p0.x, top, p0.z}},
+                    (Vector3){std::cos(mid), 0.0f, std::sin(mid)}, color,
+                    {(Vector2){0.0f, height}, (Vector2){0.0f, height}, (Vector2){height, 0.0f},
+                     (Vector2){height, 0.0f}});
+        }
+    }
+
+    /**
+     * @brief Adds a horizontal polygonal disc with its rim outlined.
+     * @param radius Distance from the center to the disc's corners
+     * @param y Height of the disc
+     * @param slices Number of segments around the circumference
+     * @param normal Direction the visible side faces, up or down
+     * @param color Vertex color of the disc
+     */
+    void addDisc(float radius, float y, int slices, Vector3 normal, Color color) {
+        // The center is the apothem away from every side, so the interpolated distance
+        // of each fragment is its exact distance to the rim.
+        const float apothem = radius * std::cos(static_cast<float>(M_PI) / slices);
+        const Vector3 center = {0.0f, y, 0.0f};
+        const unsigned short middle = addVertex(center, normal, color, (Vector2){apothem, apothem});
+        for (int i = 0; i < slices; ++i) {
+            float a0 = 2.0f * M_PI * i / slices;
+            float a1 = 2.0f * M_PI * (i + 1) / slices;
+            Vector3 p0 = {radius * std::cos(a0), y, radius * std::sin(a0)};
+            Vector3 p1 = {radius * std::cos(a1), y, radius * std::sin(a1)};
+            Vector3 faceNormal = Vector3CrossProduct(Vector3Subtract(p0, center), Vector3Subtract(p1, center));
+            if (Vector3DotProduct(faceNormal, normal) < 0.0f) {
+                std::swap(p0, p1);
+            }
+            indices.push_back(middle);
+            indices.push_back(addVertex(p0, normal, color, (Vector2){0.0f, 0.0f}));
+            indices.push_back(addVertex(p1, normal, color, (Vector2){0.0f, 0.0f}));
+        }
+    }
+
+    /**
+     * @brief Copies the triangles into a raylib mesh and uploads it to the GPU.
+     * @return The uploaded mesh, to be released with UnloadMesh()
+     */
+    Mesh upload() const {
+        Mesh mesh{};
+        mesh.vertexCount = static_cast<int>(vertices.size() / 3);
+        mesh.triangleCount = static_cast<int>(indices.size() / 3);
+        auto copy = [](const auto &source) {
+            using T = typename std::decay_t<decltype(source)>::value_type;
+            T *out = static_cast<T *>(MemAlloc(static_cast<unsigned int>(source.size() * sizeof(T))));
+            std::memcpy(out, source.data(), source.size() * sizeof(T));
+            return out;
+        };
+        mesh.vertices = copy(vertices);
+        mesh.normals = copy(normals);
+        mesh.colors = copy(colors);
+        mesh.texcoords2 = copy(edges);
+        mesh.indices = copy(indices);
+        // Untextured, but the shaders sample the default white texture at (0, 0).
+        mesh.texcoords = static_cast<float *>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * sizeof(float))));
+        UploadMesh(&mesh, false);
+        return mesh;
+    }
+};
+
+/**
+ * @brief Adds a king's crown, a base and three points, to a piece centered at the origin.
+ * @param piece The king piece being built
+ * @param radius Radius of the piece
+ * @param height Height of the piece
+ */
+void addCrown(MeshBuilder &piece, float radius, float height) {
+    float crownY = height + 0.1f;
+    float crownWidth = radius * 1.4f;
+    float crownHeight = height * 0.6f;
+    piece.addBox((Vector3){0.0f, crownY, 0.0f}, (Vector3){crownWidth, 0.1f, crownWidth * 0.6f}, GOLD);
+    for (int i = 0; i < 3; ++i) {
+        float offset = (i - 1) * crownWidth * 0.5f;
+        float pointWidth = crownWidth * 0.2f;
+        piece.addBox((Vector3){offset, crownY + crownHeight / 2.0f, 0.0f},
+                     (Vector3){pointWidth, crownHeight, pointWidth}, GOLD);
+    }
+}
+
+/**
+ * @brief Checks if a point lies inside a convex polygon of either winding.
+ * @param polygon Corners in order
+ * @param count Number of corners (>= 3)
+ * @param px Point x
+ * @param py Point y
+ * @return true if the point is inside or on an edge
+ */
+bool insideConvex(const Vector2 *polygon, int count, float px, float py) {
+    float winding = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        const Vector2 &a = polygon[i];
+        const Vector2 &b = polygon[(i + 1) % count];
+        winding += a.x * b.y - b.x * a.y;
+    }
+    for (int i = 0; i < count; ++i) {
+        const Vector2 &a = polygon[i];
+        const Vector2 &b = polygon[(i + 1) % count];
+        float side = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+        if (winding > 0 ? side < 0 : side > 0) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Gets the 3D position of the center of a board square at height 0.
+ */
+Vector3 squareCenter(int row, int col, float cellSize) {
+    return (Vector3){(col - BOARD_SIZE / 2.0f + 0.5f) * cellSize, 0.0f,
+                     (row - BOARD_SIZE / 2.0f + 0.5f) * cellSize};
+}
+
+} // namespace
+
+/**
+ * @brief Everything about the 3D scene that can be computed without the GPU.
+ * Built on a worker thread by initialize() and consumed by finishLoading().
+ */
+struct Renderer::PreparedAssets {
+    MeshBuilder board;  ///< All 64 squares
+    std::array<MeshBuilder, 4> pieces;    ///< Each piece type, index Piece - 1
+    std::array<PickingMap, 2> pickingMaps; ///< For Teal's [0] and Purple's [1] camera
+
+    /**
+     * @brief Builds the mesh geometry and both players' picking maps.
+     * @param tealView Teal's camera
+     * @param purpleView Purple's camera
+     */
+    PreparedAssets(const Camera3D &tealView, const Camera3D &purpleView) {
+        // The board: every square as a thin box, merged into one mesh.
+        for (int r = 0; r < BOARD_SIZE; ++r) {
+            for (int c = 0; c < BOARD_SIZE; ++c) {
+                board.addBox(squareCenter(r, c, CELL_SIZE), (Vector3){CELL_SIZE, 0.1f, CELL_SIZE},
+                             isDarkSquare(r, c) ? DARK_SQUARE : LIGHT_SQUARE);
+            }
+        }
+
+        // Each piece type is one vertex-colored mesh, so a man or a king of either color
+        // is a single instanced draw. The body spans half to one and a half piece heights
+        // above the square, with its edges outlined by the shader.
+        const Piece types[4] = {TealMan, PurpleMan, TealKing, PurpleKing};
+        const float bodyBottom = PIECE_HEIGHT / 2.0f;
+        const float bodyTop = bodyBottom + PIECE_HEIGHT;
+        for (Piece type : types) {
+            Color color = isTealPiece(type) ? TEAL_PIECE : PURPLE_PIECE;
+            MeshBuilder &piece = pieces[type - 1];
+            piece.addBand(PIECE_RADIUS, bodyBottom, bodyTop, PIECE_SLICES, color);
+            piece.addDisc(PIECE_RADIUS, bodyTop, PIECE_SLICES, (Vector3){0.0f, 1.0f, 0.0f}, color);
+            piece.addDisc(PIECE_RADIUS, bodyBottom, PIECE_SLICES, (Vector3){0.0f, -1.0f, 0.0f}, color);
+            if (type == TealKing || type == PurpleKing) {
+                addCrown(piece, PIECE_RADIUS, PIECE_HEIGHT);
+            }
+        }
+
+        // Both players' picking maps up front, so the first click never waits.
+        buildPickingMap(pickingMaps[0], tealView);
+        buildPickingMap(pickingMaps[1], purpleView);
+    }
+};
+
 /**
  * @brief Constructs a new Renderer and initializes Raylib.
  * Creates the main game window and sets up 3D camera.
  * @return true if initialization succeeded, false otherwise
  */
 bool Renderer::initialize() {
-    InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "8x8 Checkers - Teal vs Purple (Raylib 3D)");
+    {
+        StartupStage stage("create window");
+        InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "8x8 Checkers - Teal vs Purple (Raylib 3D)");
+    }
     
     if (!IsWindowReady()) {
         std::cerr << "Failed to initialize Raylib window\n";
@@ -30,24 +359,137 @@ bool Renderer::initialize() {
     camera.fovy = 60.0f;
     camera.projection = CAMERA_PERSPECTIVE;
 
-    // Load default font
+    // The default font is built by InitWindow, so there is nothing to load.
     font = GetFontDefault();
 
+    // Build the mesh geometry and both players' picking maps while the menu shows;
+    // only the GPU uploads in finishLoading() have to run on this thread.
+    Camera3D tealView = cameraFor(true);
+    Camera3D purpleView = cameraFor(false);
+    assetBuild = std::async(std::launch::async, [tealView, purpleView]() {
+        StartupStage stage("build meshes");
+        return std::make_unique<PreparedAssets>(tealView, purpleView);
+    });
+
     return true;
 }
 
+/**
+ * @brief Uploads the assets built in the background to the GPU once they are ready.
+ * Call once per frame while showing 2D screens; it does not wait.
+ * @return true once the assets are loaded and renderGame() may be called
+ */
+bool Renderer::finishLoading() {
+    if (!meshesLoaded && assetBuild.valid() &&
+        assetBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        StartupStage stage("upload meshes");
+        std::unique_ptr<PreparedAssets> assets = assetBuild.get();
+        loadMeshes(*assets);
+        pickingMaps = std::move(assets->pickingMaps);
+    }
+    return meshesLoaded;
+}
+
+/**
+ * @brief Waits for the background asset build and uploads the result.
+ * Must be called before the first renderGame().
+ */
+void Renderer::waitForAssets() {
+    if (assetBuild.valid()) {
+        StartupStage stage("wait for meshes");
+        assetBuild.wait();
+    }
+    finishLoading();
+}
+
 /**
  * @brief Destructor that cleans up all Raylib resources.
  */
 Renderer::~Renderer() {
+    // A build still running holds no GPU state; let it finish before the window goes.
+    if (assetBuild.valid()) {
+        assetBuild.wait();
+    }
+    if (meshesLoaded) {
+        UnloadMesh(boardMesh);
+        for (Model &model : pieceModels) {
+            UnloadModel(model);
+        }
+        UnloadMaterial(instancedMaterial);  // also unloads the instancing shader
+        UnloadMaterial(meshMaterial);
+    }
     CloseWindow();
 }
 
+/**
+ * @brief Uploads the board and piece models to the GPU and loads the shaders.
+ * Called once from finishLoading(); nothing is rebuilt per frame.
+ * @param assets Geometry built in the background
+ */
+void Renderer::loadMeshes(const PreparedAssets &assets) {
+    boardMesh = assets.board.upload();
+    for (std::size_t type = 0; type < pieceModels.size(); ++type) {
+        pieceModels[type] = LoadModelFromMesh(assets.pieces[type].upload());
+    }
+
+    meshMaterial = LoadMaterialDefault();
+    instancedMaterial = LoadMaterialDefault();
+    Shader shader = LoadShaderFromMemory(INSTANCING_VS, INSTANCING_FS);
+    instancing = shader.id != rlGetShaderIdDefault();
+    if (instancing) {
+        shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(shader, "mvp");
+        shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+        SetShaderValue(shader, GetShaderLocation(shader, "edgeWidth"), &EDGE_WIDTH, SHADER_UNIFORM_FLOAT);
+        instancedMaterial.shader = shader;
+    } else {
+        std::cerr << "Instancing shader unavailable; drawing pieces one by one without outlines\n";
+    }
+    meshesLoaded = true;
+}
+
+/**
+ * @brief Draws one mesh at many positions.
+ * Uses a single instanced draw call when the instancing shader is available,
+ * otherwise one DrawMesh call per instance.
+ * @param mesh The mesh to draw
+ * @param color Color multiplied with the mesh's vertex colors
+ * @param transforms Model matrix of each instance
+ * @param count Number of instances
+ */
+void Renderer::drawInstances(const Mesh &mesh, Color color, const Matrix *transforms, int count) {
+    if (count == 0) return;
+    if (instancing) {
+        instancedMaterial.maps[MATERIAL_MAP_DIFFUSE].color = color;
+        DrawMeshInstanced(mesh, instancedMaterial, transforms, count);
+        return;
+    }
+    meshMaterial.maps[MATERIAL_MAP_DIFFUSE].color = color;
+    for (int i = 0; i < count; ++i) {
+        DrawMesh(mesh, meshMaterial, transforms[i]);
+    }
+    meshMaterial.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
+}
+
 /**
  * @brief Updates camera position based on active player.
  * @param isTealActive Whether Teal is the active player
  */
 void Renderer::updateCamera(bool isTealActive) {
+    camera = cameraFor(isTealActive);
+
+    PickingMap &map = pickingMaps[isTealActive ? 0 : 1];
+    if (map.squares.empty() || map.cameraPosition.x != camera.position.x ||
+        map.cameraPosition.y != camera.position.y || map.cameraPosition.z != camera.position.z) {
+        buildPickingMap(map, camera);
+    }
+}
+
+/**
+ * @brief Gets the camera placed behind a player.
+ * @param isTealActive Whether the camera is Teal's
+ * @return The camera, with the current distance and angle
+ */
+Camera3D Renderer::cameraFor(bool isTealActive) const {
     float angleRad = cameraAngle * M_PI / 180.0f;
     float cameraY = cameraDistance * std::sin(angleRad);
     float cameraZDist = cameraDistance * std::cos(angleRad);
@@ -57,91 +499,161 @@ void Renderer::updateCamera(bool isTealActive) {
     // Purple (top): camera behind = positive Z (looking toward negative Z)
     float cameraZ = isTealActive ? -cameraZDist : cameraZDist;
     
-    camera.position = (Vector3){0.0f, cameraY, cameraZ};
-    camera.target = (Vector3){0.0f, 0.0f, 0.0f};
+    Camera3D view = camera;
+    view.position = (Vector3){0.0f, cameraY, cameraZ};
+    view.target = (Vector3){0.0f, 0.0f, 0.0f};
+    return view;
 }
 
 /**
- * @brief Renders a single board square in 3D.
- * @param row Board row (0-7)
- * @param col Board column (0-7)
- * @param isDark Whether this is a dark square
- * @param isSelected Whether this square is currently selected
+ * @brief Projects a point of the scene to a pixel of the board viewport.
+ * BeginMode3D takes its aspect ratio from the whole window, and the scene is then
+ * squeezed into the narrower board viewport, so x is scaled the same way.
+ * @param point Point in world space
+ * @param view The camera the board is drawn with
+ * @return Pixel position in the board viewport
  */
-void Renderer::renderBoardSquare(int row, int col, bool isDark, bool isSelected) {
-    float x = (col - BOARD_SIZE / 2.0f + 0.5f) * CELL_SIZE;
-    float z = (row - BOARD_SIZE / 2.0f + 0.5f) * CELL_SIZE;
-    
-    Color squareColor;
-    if (isSelected) {
-        squareColor = YELLOW;
-    } else if (isDark) {
-        squareColor = (Color){118, 150, 86, 255};  // Dark green
-    } else {
-        squareColor = (Color){238, 238, 210, 255}; // Light beige
-    }
-    
-    // Draw board square as a thin box
-    DrawCube((Vector3){x, 0.0f, z}, CELL_SIZE, 0.1f, CELL_SIZE, squareColor);
-    
-    // Draw selection highlight
-    if (isSelected) {
-        DrawCubeWires((Vector3){x, 0.05f, z}, CELL_SIZE, 0.1f, CELL_SIZE, YELLOW);
+Vector2 Renderer::projectToBoardView(const Vector3 &point, const Camera3D &view) {
+    const float scaleX = static_cast<float>(WINDOW_WIDTH - SIDEBAR_WIDTH) / WINDOW_WIDTH;
+    Vector2 p = GetWorldToScreenEx(point, view, WINDOW_WIDTH, WINDOW_HEIGHT);
+    return (Vector2){p.x * scaleX, p.y};
+}
+
+/**
+ * @brief Finds the piece drawn at a pixel of the board viewport.
+ * Each piece's outline is projected the way its mesh is drawn: the body, and for a
+ * king the crown above it. Where pieces overlap, the one nearest the camera wins.
+ * @param state The pieces on the board
+ * @param view The camera the board is drawn with
+ * @param px Pixel x in the board viewport
+ * @param py Pixel y in the board viewport
+ * @return row * BOARD_SIZE + col of the piece's square, -1 if no piece is there
+ */
+int Renderer::pieceAtPixel(const GameState &state, const Camera3D &view, float px, float py) {
+    // Cylinders the piece meshes fit inside, see PreparedAssets and addCrown(); the
+    // crown is narrower than the body, so its cylinder is a touch generous.
+    const float bodyBottom = PIECE_HEIGHT / 2.0f;
+    const float bodyTop = bodyBottom + PIECE_HEIGHT;
+    const float crownTop = PIECE_HEIGHT + 0.1f + PIECE_HEIGHT * 0.6f;
+
+    // Tests the outline of an upright cylinder: its two end caps and every side face.
+    auto hitsCylinder = [&](const Vector3 &base, float radius, float y0, float y1) {
+        std::array<Vector2, PIECE_SLICES> low, high;
+        for (int i = 0; i < PIECE_SLICES; ++i) {
+            float a = 2.0f * static_cast<float>(M_PI) * i / PIECE_SLICES;
+            float x = base.x + radius * std::cos(a), z = base.z + radius * std::sin(a);
+            low[i] = projectToBoardView((Vector3){x, y0, z}, view);
+            high[i] = projectToBoardView((Vector3){x, y1, z}, view);
+        }
+        if (insideConvex(high.data(), PIECE_SLICES, px, py) || insideConvex(low.data(), PIECE_SLICES, px, py)) {
+            return true;
+        }
+        for (int i = 0; i < PIECE_SLICES; ++i) {
+            int j = (i + 1) % PIECE_SLICES;
+            const Vector2 side[4] = {low[i], low[j], high[j], high[i]};
+            if (insideConvex(side, 4, px, py)) return true;
+        }
+        return false;
+    };
+
+    int found = -1;
+    float nearest = 0.0f;
+    for (int r = 0; r < BOARD_SIZE; ++r) {
+        for (int c = 0; c < BOARD_SIZE; ++c) {
+            Piece pc = state.board[r][c];
+            if (pc == Empty) continue;
+            Vector3 base = squareCenter(r, c, CELL_SIZE);
+            bool isKing = pc == TealKing || pc == PurpleKing;
+            if (!hitsCylinder(base, PIECE_RADIUS, bodyBottom, bodyTop) &&
+                !(isKing && hitsCylinder(base, PIECE_RADIUS, bodyTop, crownTop))) {
+                continue;
+            }
+            float distance = Vector3Distance(view.position, base);
+            if (found < 0 || distance < nearest) {
+                found = r * BOARD_SIZE + c;
+                nearest = distance;
+            }
+        }
     }
+    return found;
 }
 
 /**
- * @brief Renders a 3D cylindrical piece.
- * @param x X position in 3D space
- * @param z Z position in 3D space
- * @param isTeal Whether this is a teal piece (false = purple)
- * @param isKing Whether this is a king piece
+ * @brief Rebuilds a picking map by projecting every square's top face through a camera.
+ * Touches no GPU state, so it may run on any thread.
+ * @param map The map to fill
+ * @param view The camera the board is drawn with
  */
-void Renderer::renderPiece(float x, float z, bool isTeal, bool isKing) {
-    Color pieceColor = isTeal ? (Color){0, 128, 128, 255} : (Color){128, 0, 128, 255};
-    
-    // Draw cylinder (using a cube as approximation, or we could use a model)
-    // For simplicity, using a cube with rounded appearance
-    float yPos = PIECE_HEIGHT / 2.0f;
-    DrawCylinder((Vector3){x, yPos, z}, PIECE_RADIUS, PIECE_RADIUS, PIECE_HEIGHT, 32, pieceColor);
-    DrawCylinderWires((Vector3){x, yPos, z}, PIECE_RADIUS, PIECE_RADIUS, PIECE_HEIGHT, 32, BLACK);
-    
-    // Draw crown if king
-    if (isKing) {
-        renderCrown(x, z);
+void Renderer::buildPickingMap(PickingMap &map, const Camera3D &view) {
+    const int boardWidth = WINDOW_WIDTH - SIDEBAR_WIDTH;
+    map.cameraPosition = view.position;
+    map.squares.assign(static_cast<std::size_t>(boardWidth) * WINDOW_HEIGHT, -1);
+
+    const float top = 0.05f;  // top face of the board squares
+    auto project = [&](float x, float z) { return projectToBoardView((Vector3){x, top, z}, view); };
+
+    for (int r = 0; r < BOARD_SIZE; ++r) {
+        for (int c = 0; c < BOARD_SIZE; ++c) {
+            Vector3 center = squareCenter(r, c, CELL_SIZE);
+            const float h = CELL_SIZE / 2.0f;
+            const Vector2 quad[4] = {project(center.x - h, center.z - h), project(center.x + h, center.z - h),
+                                     project(center.x + h, center.z + h), project(center.x - h, center.z + h)};
+
+            // Fill the pixels whose centers lie inside the projected (convex) quad.
+            float minX = quad[0].x, maxX = quad[0].x, minY = quad[0].y, maxY = quad[0].y;
+            for (const Vector2 &p : quad) {
+                minX = std::min(minX, p.x);
+                maxX = std::max(maxX, p.x);
+                minY = std::min(minY, p.y);
+                maxY = std::max(maxY, p.y);
+            }
+            const int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+            const int x1 = std::min(boardWidth - 1, static_cast<int>(std::ceil(maxX)));
+            const int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+            const int y1 = std::min(WINDOW_HEIGHT - 1, static_cast<int>(std::ceil(maxY)));
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    if (insideConvex(quad, 4, x + 0.5f, y + 0.5f)) {
+                        map.squares[static_cast<std::size_t>(y) * boardWidth + x] =
+                            static_cast<std::int8_t>(r * BOARD_SIZE + c);
+                    }
+                }
+            }
+        }
     }
 }
 
 /**
- * @brief Renders a 3D crown on top of a king piece.
- * @param x X position in 3D space
- * @param z Z position in 3D space
+ * @brief Renders the pieces of the given state with instanced draws, one draw call
+ * per piece type on the board.
+ * @param state The game state whose pieces to draw
  */
-void Renderer::renderCrown(float x, float z) {
-    float crownY = PIECE_HEIGHT + 0.1f;
-    float crownWidth = PIECE_RADIUS * 1.4f;
-    float crownHeight = PIECE_HEIGHT * 0.6f;
-    
-    Color gold = (Color){255, 215, 0, 255};
-    
-    // Crown base
-    DrawCube((Vector3){x, crownY, z}, crownWidth, 0.1f, crownWidth * 0.6f, gold);
-    
-    // Three crown points
-    for (int i = 0; i < 3; ++i) {
-        float offset = (i - 1) * crownWidth * 0.5f;
-        float pointWidth = crownWidth * 0.2f;
-        DrawCube((Vector3){x + offset, crownY + crownHeight / 2.0f, z}, 
-                 pointWidth, crownHeight, pointWidth, gold);
+void Renderer::renderPieces(const GameState &state) {
+    std::array<std::array<Matrix, NUM_SQUARES>, 4> transforms;
+    std::array<int, 4> counts{};
+
+    for (int r = 0; r < BOARD_SIZE; ++r) {
+        for (int c = 0; c < BOARD_SIZE; ++c) {
+            Piece pc = state.board[r][c];
+            if (pc == Empty) continue;
+
+            Vector3 center = squareCenter(r, c, CELL_SIZE);
+            transforms[pc - 1][counts[pc - 1]++] = MatrixTranslate(center.x, 0.0f, center.z);
+        }
+    }
+
+    for (std::size_t type = 0; type < pieceModels.size(); ++type) {
+        drawInstances(pieceModels[type].meshes[0], WHITE, transforms[type].data(), counts[type]);
     }
 }
 
 /**
- * @brief Renders the 2D UI overlay (sidebar with piece counts).
+ * @brief Renders the 2D UI overlay (sidebar with piece counts and, if set, search statistics).
  * @param tealCount Number of teal pieces
  * @param purpleCount Number of purple pieces
  */
 void Renderer::renderUIOverlay(int tealCount, int purpleCount) {
+    PROFILE_SCOPE("Renderer::renderUIOverlay");
     int sidebarX = WINDOW_WIDTH - SIDEBAR_WIDTH;
     
     // Sidebar background
@@ -154,15 +666,117 @@ void Renderer::renderUIOverlay(int tealCount, int purpleCount) {
     // Purple indicator
     DrawRectangle(sidebarX + 20, 120, 30, 30, (Color){128, 0, 128, 255});
     DrawText(TextFormat("Purple: %d", purpleCount), sidebarX + 20, 90, 20, WHITE);
+
+    if (pathAmbiguous) {
+        DrawText("Several jumps end there;", sidebarX + 20, 150, 14, YELLOW);
+        DrawText("click each landing square", sidebarX + 20, 164, 14, YELLOW);
+    }
+
+    if (searchStats) {
+        renderSearchStats(sidebarX + 20, 180);
+    }
+#if defined(CHECKERS_PROFILE)
+    renderFrameGraph(sidebarX + 10, WINDOW_HEIGHT - FRAME_GRAPH_HEIGHT - 10, SIDEBAR_WIDTH - 20);
+#endif
+}
+
+/**
+ * @brief Renders a graph of recent frame times (profiling builds only).
+ * Bars are green within a 60 Hz frame, yellow within two and red beyond.
+ * @param x Left edge of the graph
+ * @param y Top edge of the graph, including its caption
+ * @param width Width of the graph in pixels
+ */
+void Renderer::renderFrameGraph(int x, int y, int width) {
+    float times[PROFILE_FRAME_HISTORY];
+    int count = recentFrameTimes(times);
+    if (count == 0) return;
+
+    float worst = 0.0f;
+    for (int i = 0; i < count; ++i) worst = std::max(worst, times[i]);
+    DrawText(TextFormat("Frame %.1f ms, max %.1f", times[count - 1], worst), x, y, 14, WHITE);
+
+    const int graphTop = y + 20;
+    const int graphHeight = FRAME_GRAPH_HEIGHT - 20;
+    const float scaleMs = 50.0f;  // full height; longer frames are clipped
+    DrawRectangle(x, graphTop, width, graphHeight, (Color){20, 20, 20, 255});
+    for (int i = 0; i < count; ++i) {
+        float ms = times[i];
+        int h = static_cast<int>(std::min(ms / scaleMs, 1.0f) * graphHeight);
+        int bx = x + (PROFILE_FRAME_HISTORY - count + i) * width / PROFILE_FRAME_HISTORY;
+        Color c = ms <= 16.7f ? GREEN : ms <= 33.4f ? YELLOW : RED;
+        DrawLine(bx, graphTop + graphHeight, bx, graphTop + graphHeight - h, c);
+    }
+    int budgetY = graphTop + graphHeight - static_cast<int>(16.7f / scaleMs * graphHeight);
+    DrawLine(x, budgetY, x + width, budgetY, (Color){255, 255, 255, 120});
+}
+
+/**
+ * @brief Renders the AI's search statistics below the piece counts.
+ * @param x Left edge of the panel
+ * @param y Top edge of the panel
+ */
+void Renderer::renderSearchStats(int x, int y) {
+    const SearchStats &st = *searchStats;
+    const int fontSize = 16;
+    const int lineHeight = 20;
+    const Color label = (Color){180, 180, 180, 255};
+
+    DrawText("AI search", x, y, 20, WHITE);
+    y += 30;
+    if (st.iterations.empty()) {
+        DrawText("No search (book or", x, y, fontSize, label);
+        DrawText("random move)", x, y + lineHeight, fontSize, label);
+        return;
+    }
+
+    DrawText(TextFormat("Depth: %d", st.depth), x, y, fontSize, label);
+    DrawText(TextFormat("Nodes: %.2fM", st.nodes / 1e6), x, y += lineHeight, fontSize, label);
+    DrawText(TextFormat("Speed: %.2f Mnps", st.nps() / 1e6), x, y += lineHeight, fontSize, label);
+    DrawText(TextFormat("Time: %.0f ms", st.timeMs), x, y += lineHeight, fontSize, label);
+    DrawText(TextFormat("TT hits: %.0f%%", 100.0 * st.ttHitRate()), x, y += lineHeight, fontSize, label);
+    DrawText(TextFormat("Cutoffs: %.0f%%", 100.0 * st.cutoffRatio()), x, y += lineHeight, fontSize, label);
+    DrawText(TextFormat("First-move cutoffs: %.0f%%", 100.0 * st.firstMoveCutoffRate()), x, y += lineHeight,
+             fontSize, label);
+
+    // The deepest iterations, where nearly all the time goes.
+    y += lineHeight + 10;
+    DrawText("Iterations", x, y, fontSize, WHITE);
+    const std::size_t shown = std::min<std::size_t>(st.iterations.size(), 6);
+    for (std::size_t i = st.iterations.size() - shown; i < st.iterations.size(); ++i) {
+        const IterationStats &it = st.iterations[i];
+        DrawText(TextFormat("%2d: %7.1f ms", it.depth, it.timeMs), x, y += lineHeight, fontSize, label);
+    }
+
+    // Principal variation, wrapped to the sidebar width.
+    y += lineHeight + 10;
+    DrawText("Best line", x, y, fontSize, WHITE);
+    y += lineHeight;
+    std::string line;
+    for (const Move &m : st.pv) {
+        std::string next = line.empty() ? moveToString(m) : line + " " + moveToString(m);
+        if (!line.empty() && MeasureText(next.c_str(), fontSize) > SIDEBAR_WIDTH - 30) {
+            DrawText(line.c_str(), x, y, fontSize, label);
+            y += lineHeight;
+            next = moveToString(m);
+        }
+        line = next;
+        if (y > STATS_BOTTOM - 2 * lineHeight) break;
+    }
+    if (!line.empty()) {
+        DrawText(line.c_str(), x, y, fontSize, label);
+    }
 }
 
 /**
  * @brief Renders the game board, pieces, and UI elements in 3D using Raylib.
- * Draws a 3D checkered board, 3D cylindrical pieces with crown models for kings,
- * the sidebar with piece counts, and highlights the currently selected piece.
+ * Draws the 3D checkered board, cylindrical pieces and king crowns from meshes
+ * uploaded at initialization (a handful of draw calls), the sidebar with piece
+ * counts, and highlights the currently selected piece.
  * @param state The current game state to render
  */
 void Renderer::renderGame(const GameState &state) {
+    PROFILE_SCOPE("Renderer::renderGame");
     beginDrawing();
     
     ClearBackground((Color){51, 51, 64, 255});  // Dark blue-grey background
@@ -180,42 +794,37 @@ void Renderer::renderGame(const GameState &state) {
     // Note: Raylib's BeginMode3D automatically uses the current viewport for aspect ratio
     BeginMode3D(viewportCamera);
     
-    // Render board squares
-    for (int r = 0; r < BOARD_SIZE; ++r) {
-        for (int c = 0; c < BOARD_SIZE; ++c) {
-            bool dark = isDarkSquare(r, c);
-            bool selected = (r == state.selectedRow && c == state.selectedCol);
-            renderBoardSquare(r, c, dark, selected);
-        }
+    // The whole board is one static mesh; the selected and hovered squares are drawn over it.
+    DrawMesh(boardMesh, meshMaterial, MatrixIdentity());
+    if (state.selectedRow >= 0 && state.selectedCol >= 0) {
+        Vector3 selected = squareCenter(state.selectedRow, state.selectedCol, CELL_SIZE);
+        selected.y = 0.001f;
+        DrawCube(selected, CELL_SIZE, 0.102f, CELL_SIZE, YELLOW);
+        selected.y = 0.05f;
+        DrawCubeWires(selected, CELL_SIZE, 0.1f, CELL_SIZE, YELLOW);
     }
-    
-    // Render pieces
-    int tealCount = 0;
-    int purpleCount = 0;
-    
-    for (int r = 0; r < BOARD_SIZE; ++r) {
-        for (int c = 0; c < BOARD_SIZE; ++c) {
-            Piece pc = state.board[r][c];
-            if (pc == Empty) continue;
-            
-            if (isTealPiece(pc)) ++tealCount;
-            if (isPurplePiece(pc)) ++purpleCount;
-            
-            float x = (c - BOARD_SIZE / 2.0f + 0.5f) * CELL_SIZE;
-            float z = (r - BOARD_SIZE / 2.0f + 0.5f) * CELL_SIZE;
-            
-            bool isTeal = isTealPiece(pc);
-            bool isKing = (pc == TealKing || pc == PurpleKing);
-            renderPiece(x, z, isTeal, isKing);
-        }
+    for (int sq : pathSquares) {
+        Vector3 landing = squareCenter(squareRow(sq), squareCol(sq), CELL_SIZE);
+        landing.y = 0.05f;
+        DrawCubeWires(landing, CELL_SIZE, 0.1f, CELL_SIZE, YELLOW);
     }
-    
+    bool hoverIsSelected = hoverRow == state.selectedRow && hoverCol == state.selectedCol;
+    if (hoverRow >= 0 && hoverCol >= 0 && !hoverIsSelected) {
+        Vector3 hovered = squareCenter(hoverRow, hoverCol, CELL_SIZE);
+        hovered.y = 0.05f;
+        DrawCubeWires(hovered, CELL_SIZE, 0.1f, CELL_SIZE, WHITE);
+    }
+
+    renderPieces(state);
+
     EndMode3D();
     
     // Reset viewport to full window for 2D rendering
     rlViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
     
     // Render UI overlay
+    int tealCount = 0, purpleCount = 0;
+    countPieces(state, tealCount, purpleCount);
     renderUIOverlay(tealCount, purpleCount);
     
     endDrawing();
@@ -240,96 +849,45 @@ void Renderer::beginDrawing() {
  * @brief Ends drawing frame and swaps buffers (call after rendering).
  */
 void Renderer::endDrawing() {
+    // Includes the buffer swap and any wait for vertical sync.
+    PROFILE_SCOPE("Renderer::endDrawing");
     EndDrawing();
 }
 
 /**
  * @brief Converts screen coordinates to 3D board coordinates.
- * Used for mouse picking in the 3D scene.
+ * Used for mouse picking in the 3D scene. A piece under the pointer gives its own
+ * square, even where its raised top or side covers the square behind it; elsewhere
+ * the pixel-to-square map of the board gives the square.
+ * @param state The pieces on the board
  * @param mouseX Screen X coordinate
  * @param mouseY Screen Y coordinate
  * @param outRow Output parameter for board row (-1 if invalid)
  * @param outCol Output parameter for board column (-1 if invalid)
+ * @param isTealActive Whether Teal is the active player (for camera positioning)
  */
-void Renderer::screenToBoard(int mouseX, int mouseY, int &outRow, int &outCol, bool isTealActive) const {
+void Renderer::screenToBoard(const GameState &state, int mouseX, int mouseY, int &outRow, int &outCol,
+                             bool isTealActive) const {
     outRow = -1;
     outCol = -1;
     
     // Ignore clicks in sidebar
     int boardWidth = WINDOW_WIDTH - SIDEBAR_WIDTH;
-    if (mouseX >= boardWidth) {
+    if (mouseX < 0 || mouseX >= boardWidth || mouseY < 0 || mouseY >= WINDOW_HEIGHT) {
         return;
     }
-    
-    // CRITICAL: Update camera to match the rendering state
-    // This ensures the ray calculation uses the same camera position as rendering
-    Camera3D viewportCamera = camera;
-    float angleRad = cameraAngle * M_PI / 180.0f;
-    float cameraY = cameraDistance * std::sin(angleRad);
-    float cameraZDist = cameraDistance * std::cos(angleRad);
-    // Teal (bottom): camera behind = negative Z (looking toward positive Z)
-    // Purple (top): camera behind = positive Z (looking toward negative Z)
-    float cameraZ = isTealActive ? -cameraZDist : cameraZDist;
-    viewportCamera.position = (Vector3){0.0f, cameraY, cameraZ};
-    viewportCamera.target = (Vector3){0.0f, 0.0f, 0.0f};
-    
-    // Set viewport to match 3D rendering viewport
-    rlViewport(0, 0, boardWidth, WINDOW_HEIGHT);
-    
-    // Set up 3D projection to match rendering
-    // This ensures GetMouseRay uses the same projection matrix
-    BeginMode3D(viewportCamera);
-    
-    // ROOT CAUSE ANALYSIS:
-    // GetMouseRay internally uses GetScreenWidth() and GetScreenHeight() which
-    // return the WINDOW dimensions (800x800), not the viewport dimensions (600x800).
-    // This causes the aspect ratio calculation to be wrong, resulting in
-    // the ray being calculated incorrectly.
-    //
-    // SOLUTION: We need to scale the mouse coordinates to account for the
-    // difference between window size and viewport size, OR we need to ensure
-    // GetMouseRay uses the viewport dimensions.
-    //
-    // Since we can't modify GetMouseRay, we'll adjust the mouse coordinates
-    // to compensate. The viewport is boardWidth wide, but GetMouseRay thinks
-    // the screen is WINDOW_WIDTH wide. So we need to scale mouseX.
-    float scaleX = (float)WINDOW_WIDTH / (float)boardWidth;
-    float adjustedMouseX = mouseX * scaleX;
-    
-    // GetMouseRay calculates the ray from mouse coordinates
-    // The adjusted coordinates account for the viewport/window size mismatch
-    Ray ray = GetMouseRay((Vector2){adjustedMouseX, (float)mouseY}, viewportCamera);
-    
-    EndMode3D();
-    
-    // Restore full window viewport
-    rlViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-    
-    // Check intersection with board plane (y = 0)
-    if (std::abs(ray.direction.y) > 0.001f) {
-        float t = -ray.position.y / ray.direction.y;
-        if (t > 0) {
-            Vector3 hitPoint = {
-                ray.position.x + ray.direction.x * t,
-                ray.position.y + ray.direction.y * t,
-                ray.position.z + ray.direction.z * t
-            };
-            
-            // Convert 3D hit point to board coordinates
-            // Board squares are centered at: x = (col - 3.5) * CELL_SIZE
-            // Inverse: col = (x / CELL_SIZE) + 3.5
-            float colFloat = (hitPoint.x / CELL_SIZE) + (BOARD_SIZE / 2.0f) - 0.5f;
-            float rowFloat = (hitPoint.z / CELL_SIZE) + (BOARD_SIZE / 2.0f) - 0.5f;
-            
-            // Round to nearest integer
-            int col = static_cast<int>(std::round(colFloat));
-            int row = static_cast<int>(std::round(rowFloat));
-            
-            if (inBounds(row, col)) {
-                outRow = row;
-                outCol = col;
-            }
-        }
+
+    const PickingMap &map = pickingMaps[isTealActive ? 0 : 1];
+    if (map.squares.empty()) {
+        return;
+    }
+    int square = pieceAtPixel(state, cameraFor(isTealActive), mouseX + 0.5f, mouseY + 0.5f);
+    if (square < 0) {
+        square = map.squares[static_cast<std::size_t>(mouseY) * boardWidth + mouseX];
+    }
+    if (square >= 0) {
+        outRow = square / BOARD_SIZE;
+        outCol = square % BOARD_SIZE;
     }
 }
 
@@ -0,0 +1,461 @@
+#include "SearchEngine.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+// Move ordering scores: each class of move is searched before the next one.
+constexpr int HASH_MOVE_SCORE = 1 << 30;
+constexpr int CAPTURE_SCORE = 1 << 28;  // plus the material the capture wins
+constexpr int KILLER_SCORE = 1 << 27;   // plus one for the newer killer
+constexpr int HISTORY_LIMIT = 1 << 20;  // history is halved once an entry passes this
+
+/**
+ * @brief Gets the side that moves after the given side.
+ * @param side The side that just moved (TealMan or PurpleMan)
+ * @return The opposing side
+ */
+Piece opponentOf(Piece side) {
+    return isTealPiece(side) ? PurpleMan : TealMan;
+}
+
+/**
+ * @brief Converts a score relative to the root into one relative to the node for storage,
+ * so a stored forced win keeps the right distance when reached through another path.
+ */
+int scoreToTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+/**
+ * @brief Converts a stored node-relative score back into one relative to the root.
+ */
+int scoreFromTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+/**
+ * @brief Moves the move matching a transposition table entry to the front of the list.
+ * @param moves The generated moves
+ * @param entry The entry holding the best move from an earlier search of this position
+ */
+void orderHashMoveFirst(MoveList &moves, const TTEntry &entry) {
+    if (!entry.hasMove) return;
+    // Only the squares are stored, so of several jump sequences between the same two
+    // squares the first is tried; that only costs ordering, never correctness.
+    for (int i = 0; i < moves.size(); ++i) {
+        if (moves[i].from == entry.bestFrom && moves[i].to == entry.bestTo) {
+            std::swap(moves[0], moves[i]);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Packs a move's squares into the form killer moves are stored in.
+ */
+std::uint16_t killerKey(const Move &move) {
+    return static_cast<std::uint16_t>(move.from << 8 | move.to);
+}
+
+/**
+ * @brief Moves the highest-scored move from index onwards to index, so moves are
+ * sorted only as far as the search gets before it cuts off.
+ * @param moves The moves being searched
+ * @param scores Ordering score of each move, swapped along with the moves
+ * @param index Position of the next move to search
+ */
+void pickNextMove(MoveList &moves, int *scores, int index) {
+    int best = index;
+    for (int i = index + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    if (best != index) {
+        std::swap(moves[index], moves[best]);
+        std::swap(scores[index], scores[best]);
+    }
+}
+
+/**
+ * @brief Gets the time since a point, with sub-millisecond resolution for statistics.
+ */
+double elapsedMsPrecise(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+/**
+ * @brief Searches the given position for the best move of the side to move.
+ * @param root The position to search
+ * @param side The piece type of the side to move (TealMan or PurpleMan)
+ * @param limits Depth, time and node budget for this search
+ * @param threadIndex 0 for the main search; Lazy SMP helpers pass 1, 2, ... so they
+ *        start at staggered depths and root move orders and fill the shared table
+ *        with different parts of the tree
+ * @return The best move found and search statistics
+ */
+SearchResult SearchEngine::search(const Bitboard &root, Piece side, const SearchLimits &limits,
+                                  int threadIndex) {
+    this->limits = limits;
+    startTime = Clock::now();
+    stats = SearchStats();
+    stopped = false;
+    killers = {};
+    board = root;
+    key = zobristKey(root, side);
+    material = materialScore(root, *weights);
+
+    SearchResult result;
+    MoveList rootMoves;
+    generateMoves(board, side, rootMoves);
+    if (rootMoves.empty()) {
+        return result;
+    }
+
+    result.found = true;
+    result.bestMove = rootMoves[0];
+    if (rootMoves.size() == 1) {
+        result.stats.pv.push_back(result.bestMove);
+        return result; // nothing to decide
+    }
+
+    if (threadIndex > 0) {
+        std::rotate(rootMoves.begin(), rootMoves.begin() + threadIndex % rootMoves.size(),
+                    rootMoves.end());
+    }
+
+    int maxDepth = std::clamp(limits.maxDepth, 1, MAX_PLY);
+    stats.iterations.reserve(maxDepth);
+    for (int depth = 1 + threadIndex % 2; depth <= maxDepth; ++depth) {
+        double iterationStartMs = elapsedMsPrecise(startTime);
+        std::uint64_t iterationStartNodes = stats.nodes;
+        int alpha = -INFINITE_SCORE;
+        int bestIndex = -1;
+
+        for (int i = 0; i < rootMoves.size(); ++i) {
+            const Move &m = rootMoves[i];
+            UndoRecord undo = makeMove(m);
+            int score = -negamax(opponentOf(side), depth - 1, 1, -INFINITE_SCORE, -alpha);
+            unmakeMove(m, undo);
+
+            if (stopped) break;
+            if (score > alpha) {
+                alpha = score;
+                bestIndex = i;
+            }
+        }
+
+        // The previous best move is searched first, so any move that beat it in a
+        // partial iteration is still a safe improvement.
+        if (bestIndex >= 0) {
+            result.bestMove = rootMoves[bestIndex];
+            result.score = alpha;
+            std::rotate(rootMoves.begin(), rootMoves.begin() + bestIndex,
+                        rootMoves.begin() + bestIndex + 1);
+        }
+        if (stopped) break;
+        stats.depth = depth;
+        stats.iterations.push_back({depth, alpha, stats.nodes - iterationStartNodes,
+                                    elapsedMsPrecise(startTime) - iterationStartMs});
+        if (tt) {
+            tt->store(key, depth, Bound::Exact, scoreToTT(alpha, 0), &result.bestMove);
+        }
+
+        // A forced win or loss will not change with more depth.
+        if (std::abs(alpha) >= MATE_BOUND) break;
+
+        // The next iteration would take several times longer than this one; don't
+        // start it if it cannot finish within the budget.
+        if (limits.timeLimitMs > 0 && elapsedMs() * 2 > limits.timeLimitMs) break;
+    }
+
+    stats.timeMs = elapsedMsPrecise(startTime);
+    result.stats = std::move(stats);
+    // Helpers only fill the table, so only the main search pays for walking it.
+    if (threadIndex == 0) {
+        result.stats.pv = principalVariation(side, result.bestMove, std::max(result.stats.depth, 1));
+    }
+    return result;
+}
+
+/**
+ * @brief Plays a move on the search position and updates its key and material score.
+ * @param move The legal move to play
+ * @return The record needed by unmakeMove()
+ */
+UndoRecord SearchEngine::makeMove(const Move &move) {
+    UndoRecord undo = ::makeMove(board, move);
+    key ^= zobristMoveDelta(board, move, undo);
+    material += materialMoveDelta(board, move, undo, *weights);
+    return undo;
+}
+
+/**
+ * @brief Takes back a move played with makeMove(), restoring the position, key and score.
+ * @param move The move that was played
+ * @param undo The record returned when the move was played
+ */
+void SearchEngine::unmakeMove(const Move &move, const UndoRecord &undo) {
+    key ^= zobristMoveDelta(board, move, undo);
+    material -= materialMoveDelta(board, move, undo, *weights);
+    ::unmakeMove(board, move, undo);
+}
+
+/**
+ * @brief Alpha-beta search of one subtree of the search position.
+ * @param side The side to move
+ * @param depth Remaining depth in plies
+ * @param ply Distance from the root
+ * @param alpha Lower bound of the search window
+ * @param beta Upper bound of the search window
+ * @return Score from the side to move's perspective
+ */
+int SearchEngine::negamax(Piece side, int depth, int ply, int alpha, int beta) {
+    // A tablebase result is exact, so it ends the search here even at the horizon.
+    TBResult known;
+    if (tablebase && popCount(board.teal | board.purple) <= tablebase->maxPieces() &&
+        tablebase->probe(board, side, known)) {
+        visitNode();
+        ++stats.tbHits;
+        if (known.outcome == TBOutcome::Win) return WIN_SCORE - (ply + known.distance);
+        if (known.outcome == TBOutcome::Loss) return -(WIN_SCORE - (ply + known.distance));
+        return 0;
+    }
+
+    if (depth <= 0 || ply >= MAX_PLY) {
+        return quiescence(side, ply, alpha, beta);
+    }
+
+    visitNode();
+    if (stopped) return 0;
+
+    TTEntry entry;
+    bool hit = false;
+    if (tt) {
+        ++stats.ttProbes;
+        hit = tt->probe(key, entry);
+        stats.ttHits += hit;
+    }
+    if (hit && entry.depth >= depth) {
+        int score = scoreFromTT(entry.score, ply);
+        if (entry.bound == Bound::Exact) return score;
+        if (entry.bound == Bound::Lower && score >= beta) return score;
+        if (entry.bound == Bound::Upper && score <= alpha) return score;
+    }
+
+    MoveList moves;
+    generateMoves(board, side, moves);
+    if (moves.empty()) {
+        return -(WIN_SCORE - ply); // no moves: the side to move loses
+    }
+    int scores[MAX_MOVES];
+    scoreMoves(moves, side, ply, hit && entry.hasMove ? &entry : nullptr, scores);
+
+    ++stats.expandedNodes;
+    int originalAlpha = alpha;
+    int best = -INFINITE_SCORE;
+    const Move *bestMove = nullptr;
+    for (int i = 0; i < moves.size(); ++i) {
+        // Moves before i are never swapped again, so bestMove stays valid.
+        pickNextMove(moves, scores, i);
+        const Move &m = moves[i];
+        UndoRecord undo = makeMove(m);
+        int score = -negamax(opponentOf(side), depth - 1, ply + 1, -beta, -alpha);
+        unmakeMove(m, undo);
+
+        if (stopped) return 0;
+        if (score > best) {
+            best = score;
+            bestMove = &m;
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) {
+                ++stats.betaCutoffs;
+                stats.firstMoveCutoffs += i == 0;
+                if (!m.isCapture()) recordCutoff(m, side, depth, ply);
+                break;
+            }
+        }
+    }
+
+    if (tt) {
+        Bound bound = best >= beta ? Bound::Lower
+                    : best <= originalAlpha ? Bound::Upper
+                    : Bound::Exact;
+        tt->store(key, depth, bound, scoreToTT(best, ply), bestMove);
+    }
+    return best;
+}
+
+/**
+ * @brief Search of forced captures at the horizon so leaves are not scored mid-exchange.
+ * @param side The side to move
+ * @param ply Distance from the root
+ * @param alpha Lower bound of the search window
+ * @param beta Upper bound of the search window
+ * @return Score from the side to move's perspective
+ */
+int SearchEngine::quiescence(Piece side, int ply, int alpha, int beta) {
+    visitNode();
+    if (stopped) return 0;
+
+    MoveList moves;
+    generateMoves(board, side, moves);
+    if (moves.empty()) {
+        return -(WIN_SCORE - ply);
+    }
+
+    // Captures are mandatory, so the side to move may only stand pat when it has none.
+    if (!moves[0].isCapture() || ply >= MAX_PLY) {
+        return evaluateWithMaterial(board, side, material, *weights);
+    }
+
+    // Only captures get here, so they are ordered by gain alone.
+    int scores[MAX_MOVES];
+    scoreMoves(moves, side, ply, nullptr, scores);
+
+    int best = -INFINITE_SCORE;
+    for (int i = 0; i < moves.size(); ++i) {
+        pickNextMove(moves, scores, i);
+        const Move &m = moves[i];
+        UndoRecord undo = makeMove(m);
+        int score = -quiescence(opponentOf(side), ply + 1, -beta, -alpha);
+        unmakeMove(m, undo);
+
+        if (stopped) return 0;
+        if (score > best) {
+            best = score;
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) break;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Gives each move an ordering score, higher to be searched first.
+ * @param moves The generated moves
+ * @param side The side to move
+ * @param ply Distance from the root, selects the killer moves
+ * @param hashMove Transposition table entry with a best move, or nullptr
+ * @param scores Output array, one score per move
+ */
+void SearchEngine::scoreMoves(const MoveList &moves, Piece side, int ply, const TTEntry *hashMove,
+                              int *scores) const {
+    const auto &sideHistory = history[isTealPiece(side) ? 0 : 1];
+    const auto &plyKillers = killers[std::min(ply, MAX_PLY - 1)];
+    for (int i = 0; i < moves.size(); ++i) {
+        const Move &m = moves[i];
+        // Only the squares of the hash move are stored, so of several jump sequences
+        // between the same two squares the first one to match gets the bonus; it is at
+        // worst a misordering, never a wrong result.
+        if (hashMove && m.from == hashMove->bestFrom && m.to == hashMove->bestTo) {
+            scores[i] = HASH_MOVE_SCORE;
+            hashMove = nullptr;
+        } else if (m.isCapture()) {
+            int kings = popCount(m.captured & board.kings);
+            int men = popCount(m.captured) - kings;
+            scores[i] = CAPTURE_SCORE + men * weights->manValue + kings * weights->kingValue;
+        } else if (killerKey(m) == plyKillers[0]) {
+            scores[i] = KILLER_SCORE + 1;
+        } else if (killerKey(m) == plyKillers[1]) {
+            scores[i] = KILLER_SCORE;
+        } else {
+            scores[i] = sideHistory[m.from][m.to];
+        }
+    }
+}
+
+/**
+ * @brief Records a quiet move that caused a beta cutoff as a killer and in the history.
+ * @param move The move
+ * @param side The side that played it
+ * @param depth Remaining depth of the node, deeper cutoffs weigh more
+ * @param ply Distance from the root
+ */
+void SearchEngine::recordCutoff(const Move &move, Piece side, int depth, int ply) {
+    auto &plyKillers = killers[std::min(ply, MAX_PLY - 1)];
+    std::uint16_t moveKey = killerKey(move);
+    if (plyKillers[0] != moveKey) {
+        plyKillers[1] = plyKillers[0];
+        plyKillers[0] = moveKey;
+    }
+
+    auto &sideHistory = history[isTealPiece(side) ? 0 : 1];
+    int &value = sideHistory[move.from][move.to];
+    value += depth * depth;
+    if (value > HISTORY_LIMIT) {
+        for (auto &fromHistory : sideHistory) {
+            for (int &entry : fromHistory) entry /= 2;
+        }
+    }
+}
+
+/**
+ * @brief Counts a node and sets stopped once the time or node budget is used up
+ * or the stop flag is raised.
+ */
+void SearchEngine::visitNode() {
+    std::uint64_t nodes = ++stats.nodes;
+    if (stopFlag && stopFlag->load(std::memory_order_relaxed)) {
+        stopped = true;
+    }
+    if (limits.nodeLimit > 0 && nodes >= limits.nodeLimit) {
+        stopped = true;
+    }
+    // Reading the clock is comparatively slow, so only do it every 1024 nodes.
+    if (limits.timeLimitMs > 0 && (nodes & 1023) == 0 && elapsedMs() >= limits.timeLimitMs) {
+        stopped = true;
+    }
+}
+
+/**
+ * @brief Gets the time spent on the running search.
+ * @return Elapsed milliseconds since the search started
+ */
+std::int64_t SearchEngine::elapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+}
+
+/**
+ * @brief Follows best moves stored in the transposition table from the root.
+ * @param side The side to move at the root
+ * @param bestMove The move chosen at the root
+ * @param maxLength Longest variation to return
+ * @return The principal variation, starting with bestMove
+ */
+std::vector<Move> SearchEngine::principalVariation(Piece side, const Move &bestMove, int maxLength) {
+    std::vector<Move> pv;
+    std::vector<UndoRecord> undos;
+    pv.reserve(maxLength);
+    undos.reserve(maxLength);
+    pv.push_back(bestMove);
+    undos.push_back(makeMove(bestMove));
+    side = opponentOf(side);
+
+    // Stored moves are only from/to pairs, so each one is matched against the legal
+    // moves; the walk ends at the first miss or stale entry, and maxLength keeps a
+    // repetition from looping.
+    TTEntry entry;
+    while (tt && static_cast<int>(pv.size()) < maxLength && tt->probe(key, entry) && entry.hasMove) {
+        MoveList moves;
+        generateMoves(board, side, moves);
+        orderHashMoveFirst(moves, entry);
+        if (moves.empty() || moves[0].from != entry.bestFrom || moves[0].to != entry.bestTo) break;
+        pv.push_back(moves[0]);
+        undos.push_back(makeMove(moves[0]));
+        side = opponentOf(side);
+    }
+
+    for (int i = static_cast<int>(pv.size()) - 1; i >= 0; --i) {
+        unmakeMove(pv[i], undos[i]);
+    }
+    return pv;
+}
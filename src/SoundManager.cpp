@@ -1,24 +1,22 @@
 #include "SoundManager.h"
+#include "Profiler.h"
+#include "StartupTimings.h"
 
+#include <chrono>
 #include <iostream>
+#include <utility>
 
 /**
- * @brief Constructs a new SoundManager and initializes the audio system.
- * Attempts to initialize Raylib audio and load sound effect files.
- * If demo.mp3 exists, it will be used for all sound effects.
+ * @brief Constructs a new SoundManager and starts the audio system in the background.
+ * Initializes Raylib audio and decodes the sound effect files on a worker thread;
+ * sounds played before they are ready are skipped.
+ * If demo.mp3 exists, it will be used for all sound effects. If music.mp3 exists,
+ * it is streamed in a loop once loading finishes.
  */
 SoundManager::SoundManager()
-    : initialized(false), demo{}, move{}, capture{}, win{}, lose{}
+    : initialized(false)
 {
-    // Initialize Raylib audio
-    InitAudioDevice();
-    
-    if (!IsAudioDeviceReady()) {
-        std::cerr << "Failed to initialize audio device\n";
-        return;
-    }
-
-    initialized = true;
+    effectClip.fill(-1);
     loadSounds();
 }
 
@@ -26,14 +24,30 @@ SoundManager::SoundManager()
  * @brief Destructor that cleans up all loaded sounds and closes the audio system.
  */
 SoundManager::~SoundManager() {
-    // Unload sounds (check if frameCount > 0 to see if sound was loaded)
-    if (demo.frameCount > 0) {
-        UnloadSound(demo);
-    } else {
-        if (move.frameCount > 0)    UnloadSound(move);
-        if (capture.frameCount > 0) UnloadSound(capture);
-        if (win.frameCount > 0)     UnloadSound(win);
-        if (lose.frameCount > 0)    UnloadSound(lose);
+    // A decode still running must finish before its waves can be freed.
+    if (loading.valid()) {
+        LoadResult result = loading.get();
+        initialized = result.audioReady;
+        for (DecodedClip &decoded : result.decoded) {
+            UnloadWave(decoded.wave);
+        }
+    }
+
+    for (Clip &clip : clips) {
+        if (clip.music.frameCount > 0) {
+            UnloadMusicStream(clip.music);
+        }
+        // Aliases must go before the sound that owns their samples.
+        for (int i = clip.voiceCount - 1; i > 0; --i) {
+#if RAYLIB_VERSION_MAJOR >= 5
+            UnloadSoundAlias(clip.voices[i]);
+#else
+            UnloadSound(clip.voices[i]);
+#endif
+        }
+        if (clip.voiceCount > 0) {
+            UnloadSound(clip.voices[0]);
+        }
     }
 
     if (initialized) {
@@ -42,91 +56,200 @@ SoundManager::~SoundManager() {
 }
 
 /**
- * @brief Loads sound effect files from the assets directory.
+ * @brief Chooses the sound files, then starts the audio device and decodes the
+ * effect clips in the background.
  * If demo.mp3 exists, it will be used for all sound effects.
  * Otherwise, loads individual MP3 files for move, capture, win, and lose.
+ * The music track, music.mp3, is only opened for streaming once loading finishes.
  */
 void SoundManager::loadSounds() {
-    // If demo.mp3 exists and loads, use it for all sound effects.
+    auto addClip = [this](const char *path, bool streamed) {
+        Clip clip;
+        clip.path = path;
+        clip.streamed = streamed;
+        clips.push_back(clip);
+        return static_cast<int>(clips.size()) - 1;
+    };
+
+    // Effects are replayed often and overlap, so they are always decoded once; only
+    // the music track is long enough to be worth streaming.
     if (FileExists("assets/demo.mp3")) {
-        demo = LoadSound("assets/demo.mp3");
-        if (demo.frameCount > 0) {
-            std::cout << "Using demo.mp3 for all sound effects\n";
-            return;
+        effectClip.fill(addClip("assets/demo.mp3", false));
+        std::cout << "Using demo.mp3 for all sound effects\n";
+    } else {
+        const char *paths[EFFECT_COUNT] = {"assets/move.mp3", "assets/capture.mp3", "assets/win.mp3",
+                                           "assets/lose.mp3"};
+        for (int effect = 0; effect < EFFECT_COUNT; ++effect) {
+            if (FileExists(paths[effect])) {
+                effectClip[effect] = addClip(paths[effect], false);
+            }
+        }
+    }
+    if (FileExists("assets/music.mp3")) {
+        addClip("assets/music.mp3", true);
+    }
+
+    // Starting the device and decoding can run while the window starts up; the audio
+    // buffers are created from the waves on the main thread in update().
+    std::vector<std::pair<int, std::string>> toDecode;
+    for (std::size_t i = 0; i < clips.size(); ++i) {
+        if (!clips[i].streamed) {
+            toDecode.emplace_back(static_cast<int>(i), clips[i].path);
+        }
+    }
+    loading = std::async(std::launch::async, [toDecode]() {
+        LoadResult result;
+        {
+            StartupStage stage("audio device");
+            InitAudioDevice();
+        }
+        result.audioReady = IsAudioDeviceReady();
+        if (!result.audioReady) {
+            std::cerr << "Failed to initialize audio device\n";
+            return result;
+        }
+
+        StartupStage stage("decode sounds");
+        PROFILE_SCOPE("SoundManager::decode");
+        for (const auto &entry : toDecode) {
+            Wave wave = LoadWave(entry.second.c_str());
+            if (wave.frameCount > 0) {
+                result.decoded.push_back({entry.first, wave});
+            } else {
+                std::cerr << "Cannot decode " << entry.second << "\n";
+            }
+        }
+        return result;
+    });
+}
+
+/**
+ * @brief Turns the decoded waves into voice pools and starts the music stream.
+ * @param result The background loader's result; its waves are freed
+ */
+void SoundManager::finishLoading(LoadResult result) {
+    PROFILE_SCOPE("SoundManager::finishLoading");
+    initialized = result.audioReady;
+    if (!initialized) {
+        return;
+    }
+
+    StartupStage stage("upload sounds");
+    for (DecodedClip &entry : result.decoded) {
+        Clip &clip = clips[entry.clip];
+        clip.voices[0] = LoadSoundFromWave(entry.wave);
+        if (clip.voices[0].frameCount > 0) {
+            clip.voiceCount = VOICES;
+            for (int i = 1; i < VOICES; ++i) {
+#if RAYLIB_VERSION_MAJOR >= 5
+                // Aliases play the same samples without another copy.
+                clip.voices[i] = LoadSoundAlias(clip.voices[0]);
+#else
+                clip.voices[i] = LoadSoundFromWave(entry.wave);
+#endif
+            }
         }
+        UnloadWave(entry.wave);
     }
 
-    // Otherwise, load individual sound files
-    if (FileExists("assets/move.mp3")) {
-        move = LoadSound("assets/move.mp3");
+    for (Clip &clip : clips) {
+        if (clip.streamed) {
+            clip.music = LoadMusicStream(clip.path.c_str());
+            if (clip.music.frameCount == 0) {
+                std::cerr << "Cannot open " << clip.path << "\n";
+                continue;
+            }
+            clip.music.looping = true;
+            PlayMusicStream(clip.music);
+        }
     }
-    if (FileExists("assets/capture.mp3")) {
-        capture = LoadSound("assets/capture.mp3");
+}
+
+/**
+ * @brief Finishes loading once the background decode is done and refills the
+ * music stream's buffers. Call once per frame.
+ */
+void SoundManager::update() {
+    if (loading.valid() && loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        finishLoading(loading.get());
     }
-    if (FileExists("assets/win.mp3")) {
-        win = LoadSound("assets/win.mp3");
+    for (Clip &clip : clips) {
+        if (clip.streamed && clip.music.frameCount > 0 && IsMusicStreamPlaying(clip.music)) {
+            UpdateMusicStream(clip.music);
+        }
     }
-    if (FileExists("assets/lose.mp3")) {
-        lose = LoadSound("assets/lose.mp3");
+}
+
+/**
+ * @brief Checks whether update() still has work to do.
+ * @return true while sounds are loading or the music is playing
+ */
+bool SoundManager::needsUpdate() const {
+    if (loading.valid()) {
+        return true;
+    }
+    for (const Clip &clip : clips) {
+        if (clip.streamed && clip.music.frameCount > 0 && IsMusicStreamPlaying(clip.music)) {
+            return true;
+        }
     }
+    return false;
 }
 
 /**
- * @brief Plays a sound effect, stopping any currently playing sound first.
- * @param sound The sound to play
+ * @brief Plays an effect's clip on a free voice, restarting the oldest voice if all
+ * are busy.
+ * @param effect The effect to play
  */
-void SoundManager::playSound(Sound sound) {
-    if (sound.frameCount == 0) return;  // Sound not loaded
-    
-    // Stop any currently playing sound and play the new one
-    StopSound(sound);  // Stop this specific sound if playing
-    PlaySound(sound);
+void SoundManager::playEffect(Effect effect) {
+    PROFILE_SCOPE("SoundManager::playEffect");
+    if (effectClip[effect] < 0) return;  // No file for this effect
+    Clip &clip = clips[effectClip[effect]];
+
+    if (clip.voiceCount == 0) return;  // Still decoding
+    int voice = -1;
+    for (int i = 0; i < clip.voiceCount; ++i) {
+        if (!IsSoundPlaying(clip.voices[i])) {
+            voice = i;
+            break;
+        }
+    }
+    if (voice < 0) {
+        voice = clip.nextVoice;
+        StopSound(clip.voices[voice]);
+    }
+    clip.nextVoice = (voice + 1) % clip.voiceCount;
+    PlaySound(clip.voices[voice]);
 }
 
 /**
  * @brief Plays the move sound effect.
- * Stops any currently playing sound before playing the new one.
+ * Uses a free voice, or restarts the oldest one if all are busy.
  */
 void SoundManager::playMove() {
-    if (demo.frameCount > 0) {
-        playSound(demo);
-    } else if (move.frameCount > 0) {
-        playSound(move);
-    }
+    playEffect(MoveEffect);
 }
 
 /**
  * @brief Plays the capture sound effect.
- * Stops any currently playing sound before playing the new one.
+ * Uses a free voice, or restarts the oldest one if all are busy.
  */
 void SoundManager::playCapture() {
-    if (demo.frameCount > 0) {
-        playSound(demo);
-    } else if (capture.frameCount > 0) {
-        playSound(capture);
-    }
+    playEffect(CaptureEffect);
 }
 
 /**
  * @brief Plays the victory sound effect.
- * Stops any currently playing sound before playing the new one.
+ * Uses a free voice, or restarts the oldest one if all are busy.
  */
 void SoundManager::playWin() {
-    if (demo.frameCount > 0) {
-        playSound(demo);
-    } else if (win.frameCount > 0) {
-        playSound(win);
-    }
+    playEffect(WinEffect);
 }
 
 /**
  * @brief Plays the defeat sound effect.
- * Stops any currently playing sound before playing the new one.
+ * Uses a free voice, or restarts the oldest one if all are busy.
  */
 void SoundManager::playLose() {
-    if (demo.frameCount > 0) {
-        playSound(demo);
-    } else if (lose.frameCount > 0) {
-        playSound(lose);
-    }
+    playEffect(LoseEffect);
 }
@@ -0,0 +1,79 @@
+#include "StartupTimings.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief One finished stage, in milliseconds since launch.
+ */
+struct StageRecord {
+    const char *name;
+    double startMs;
+    double durationMs;
+    bool mainThread;
+};
+
+// Taken during static initialization, as close to launch as the program can get.
+const Clock::time_point launch = Clock::now();
+const std::thread::id mainThreadId = std::this_thread::get_id();
+
+std::mutex stageMutex;
+std::vector<StageRecord> stages;
+
+double msSinceLaunch(Clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(t - launch).count();
+}
+
+void record(const char *name, Clock::time_point start, Clock::time_point end) {
+    double startMs = msSinceLaunch(start);
+    std::lock_guard<std::mutex> lock(stageMutex);
+    stages.push_back({name, startMs, msSinceLaunch(end) - startMs, std::this_thread::get_id() == mainThreadId});
+}
+
+} // namespace
+
+/**
+ * @brief Stops timing and records the stage.
+ */
+StartupStage::~StartupStage() {
+    record(name, start, Clock::now());
+}
+
+/**
+ * @brief Records a moment of startup, such as the first frame, as a stage of no duration.
+ * @param name Milestone name, a string literal
+ */
+void markStartup(const char *name) {
+    Clock::time_point now = Clock::now();
+    record(name, now, now);
+}
+
+/**
+ * @brief Writes every recorded stage with its start, duration and thread.
+ * @param out Stream to write to
+ */
+void printStartupTimings(std::ostream &out) {
+    std::vector<StageRecord> sorted;
+    {
+        std::lock_guard<std::mutex> lock(stageMutex);
+        sorted = stages;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const StageRecord &a, const StageRecord &b) { return a.startMs < b.startMs; });
+
+    out << "Startup timings (ms since launch):\n";
+    char line[128];
+    for (const StageRecord &stage : sorted) {
+        std::snprintf(line, sizeof(line), "  %-22s at %8.1f  took %8.1f  (%s)\n", stage.name, stage.startMs,
+                      stage.durationMs, stage.mainThread ? "main" : "worker");
+        out << line;
+    }
+}
@@ -0,0 +1,70 @@
+#include "TrainingData.h"
+#include "GameLogic.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Gets the file name of one shard of a data set.
+ * @param prefix Path prefix of the data set, e.g. "data/run1"
+ * @param index Shard number
+ * @return The shard's path, e.g. "data/run1-003.train"
+ */
+std::string trainingShardPath(const std::string &prefix, int index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%03d.train", index);
+    return prefix + suffix;
+}
+
+/**
+ * @brief Creates a shard, replacing any existing file.
+ * @param path The file to write
+ * @return true if the file is open, false if it cannot be created
+ */
+bool TrainingShardWriter::open(const std::string &path) {
+    out.close();
+    count = 0;
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    TrainingFileHeader header{};
+    std::memcpy(header.magic, TRAINING_MAGIC, sizeof(TRAINING_MAGIC));
+    header.rulesVersion = RULES_VERSION;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Appends a position.
+ * @param position The labelled position
+ */
+void TrainingShardWriter::add(const TrainingPosition &position) {
+    out.write(reinterpret_cast<const char *>(&position), sizeof(position));
+    ++count;
+}
+
+/**
+ * @brief Flushes and closes the file.
+ * @return true if every position was written, false on an I/O error
+ */
+bool TrainingShardWriter::close() {
+    out.close();
+    return !out.fail();
+}
+
+/**
+ * @brief Maps a shard, closing any previously opened one.
+ * @param path Path of a file written by TrainingShardWriter
+ * @return true if the file was mapped and is valid for the current rules
+ */
+bool TrainingShard::open(const std::string &path) {
+    count = 0;
+    if (!openDataFile(file, path, TRAINING_MAGIC, sizeof(TrainingFileHeader), "Training shard",
+                      "regenerate it with checkers_selfplay --train-out")) {
+        return false;
+    }
+    // A shard cut short while being written keeps every complete position.
+    count = (file.size() - sizeof(TrainingFileHeader)) / sizeof(TrainingPosition);
+    return true;
+}
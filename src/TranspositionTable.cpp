@@ -0,0 +1,124 @@
+#include "TranspositionTable.h"
+
+namespace {
+
+// Layout of the packed 64-bit entry.
+constexpr int SCORE_SHIFT = 0;       // 16 bits, stored biased so it is non-negative
+constexpr int DEPTH_SHIFT = 16;      // 8 bits
+constexpr int BOUND_SHIFT = 24;      // 2 bits
+constexpr int FROM_SHIFT = 26;       // 5 bits
+constexpr int TO_SHIFT = 31;         // 5 bits
+constexpr int HAS_MOVE_SHIFT = 36;   // 1 bit
+constexpr int GENERATION_SHIFT = 37; // 8 bits
+
+constexpr int SCORE_BIAS = 32768;
+
+std::uint64_t field(std::uint64_t data, int shift, int bits) {
+    return (data >> shift) & ((std::uint64_t{1} << bits) - 1);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a table using about the given amount of memory.
+ * @param sizeMb Table size in megabytes (rounded down to a power-of-two slot count)
+ */
+TranspositionTable::TranspositionTable(std::size_t sizeMb) {
+    resize(sizeMb);
+}
+
+/**
+ * @brief Reallocates the table with a new size, discarding all entries.
+ * Must not be called while a search is using the table.
+ * @param sizeMb Table size in megabytes
+ */
+void TranspositionTable::resize(std::size_t sizeMb) {
+    std::size_t bytes = (sizeMb > 0 ? sizeMb : 1) * 1024 * 1024;
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Slot) <= bytes) {
+        count *= 2;
+    }
+
+    slots = std::make_unique<Slot[]>(count);
+    mask = count - 1;
+    sizeInMb = sizeMb;
+    generation = 0;
+}
+
+/**
+ * @brief Discards all entries.
+ * Must not be called while a search is using the table.
+ */
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i <= mask; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+    generation = 0;
+}
+
+/**
+ * @brief Marks the start of a new search so entries from older searches are replaced first.
+ */
+void TranspositionTable::newSearch() {
+    ++generation;
+}
+
+/**
+ * @brief Looks up a position.
+ * @param key Zobrist key of the position
+ * @param entry Output parameter filled on a hit
+ * @return true if the table holds an entry for the key, false otherwise
+ */
+bool TranspositionTable::probe(std::uint64_t key, TTEntry &entry) const {
+    const Slot &slot = slots[key & mask];
+    std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+    std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || data == 0) {
+        return false;
+    }
+
+    entry.score = static_cast<int>(field(data, SCORE_SHIFT, 16)) - SCORE_BIAS;
+    entry.depth = static_cast<int>(field(data, DEPTH_SHIFT, 8));
+    entry.bound = static_cast<Bound>(field(data, BOUND_SHIFT, 2));
+    entry.bestFrom = static_cast<std::uint8_t>(field(data, FROM_SHIFT, 5));
+    entry.bestTo = static_cast<std::uint8_t>(field(data, TO_SHIFT, 5));
+    entry.hasMove = field(data, HAS_MOVE_SHIFT, 1) != 0;
+    return true;
+}
+
+/**
+ * @brief Stores a search result, replacing the slot if the new result is more useful.
+ * @param key Zobrist key of the position
+ * @param depth Remaining depth the score was searched to
+ * @param bound How score bounds the true value
+ * @param score Score relative to the node
+ * @param bestMove Best move found, or nullptr if none
+ */
+void TranspositionTable::store(std::uint64_t key, int depth, Bound bound, int score, const Move *bestMove) {
+    Slot &slot = slots[key & mask];
+
+    // Keep a deeper result for another position from the current search; anything
+    // from an older search, or for the same position, is replaced.
+    std::uint64_t old = slot.data.load(std::memory_order_relaxed);
+    std::uint64_t oldKey = slot.check.load(std::memory_order_relaxed) ^ old;
+    if (old != 0 && oldKey != key &&
+        field(old, GENERATION_SHIFT, 8) == generation &&
+        static_cast<int>(field(old, DEPTH_SHIFT, 8)) > depth) {
+        return;
+    }
+
+    std::uint64_t data = 0;
+    data |= static_cast<std::uint64_t>(score + SCORE_BIAS) << SCORE_SHIFT;
+    data |= static_cast<std::uint64_t>(depth < 0 ? 0 : depth) << DEPTH_SHIFT;
+    data |= static_cast<std::uint64_t>(bound) << BOUND_SHIFT;
+    if (bestMove) {
+        data |= static_cast<std::uint64_t>(bestMove->from) << FROM_SHIFT;
+        data |= static_cast<std::uint64_t>(bestMove->to) << TO_SHIFT;
+        data |= std::uint64_t{1} << HAS_MOVE_SHIFT;
+    }
+    data |= static_cast<std::uint64_t>(generation) << GENERATION_SHIFT;
+
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
@@ -1,22 +1,78 @@
 // Simple 8x8 checkers game using Raylib for 3D graphics
 // Teal vs Purple pieces, with a sidebar showing remaining piece counts and AI opponent.
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "GameLogic.h"
 #include "CheckersAI.h"
+#include "GameRecord.h"
+#include "Profiler.h"
 #include "SoundManager.h"
+#include "StartupTimings.h"
 #include "Renderer.h"
 
+/**
+ * @brief Everything the picture on screen depends on.
+ * A frame is only drawn when this changes, so an idle board costs no CPU or GPU time.
+ */
+struct FrameKey {
+    GameState state;
+    bool showPopup = false;
+    GameResult result = GameResult::Ongoing;
+    const SearchStats *stats = nullptr;  ///< Stats shown in the sidebar, nullptr if hidden
+    unsigned statsVersion = 0;           ///< Bumped whenever the shown stats are replaced
+    int hoverRow = -1;                   ///< Highlighted square under the pointer
+    int hoverCol = -1;
+    std::size_t pathLength = 0;          ///< Landing squares of the jump being entered
+    bool pathAmbiguous = false;
+    bool focused = false;
+    bool minimized = false;
+
+    bool operator==(const FrameKey &other) const {
+        return state.board == other.state.board && state.currentPlayer == other.state.currentPlayer &&
+               state.selectedRow == other.state.selectedRow && state.selectedCol == other.state.selectedCol &&
+               showPopup == other.showPopup && result == other.result && stats == other.stats &&
+               statsVersion == other.statsVersion && hoverRow == other.hoverRow &&
+               hoverCol == other.hoverCol && pathLength == other.pathLength &&
+               pathAmbiguous == other.pathAmbiguous && focused == other.focused &&
+               minimized == other.minimized;
+    }
+    bool operator!=(const FrameKey &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief A jump of the selected piece being entered one landing square at a time.
+ */
+struct PendingPath {
+    std::vector<int> landings;  ///< Packed squares clicked so far, in order
+    bool ambiguous = false;     ///< Whether the last click ended several jump sequences
+
+    void clear() {
+        landings.clear();
+        ambiguous = false;
+    }
+};
+
 /**
  * @brief Handles mouse click events on the game board.
  * Manages piece selection and move execution for the human player.
+ * A move is entered by clicking its final square, or, when several jump sequences
+ * end there, by clicking each square the piece lands on in turn.
  * @param state The current game state (will be modified if a move is made)
  * @param renderer The renderer for coordinate conversion
+ * @param path Landing squares clicked so far for the selected piece
  * @param wasCapture Output parameter set to true if the move resulted in a capture, false otherwise
+ * @param played Output parameter receiving the move, set when a move was executed
  * @return true if a move was successfully executed, false otherwise (selection change or invalid click)
  */
-bool handleClick(GameState &state, Renderer &renderer, bool &wasCapture) {
+bool handleClick(GameState &state, Renderer &renderer, PendingPath &path, bool &wasCapture, Move &played) {
     Vector2 mousePos = renderer.getMousePosition();
     int mouseX = (int)mousePos.x;
     int mouseY = (int)mousePos.y;
@@ -26,7 +82,7 @@ bool handleClick(GameState &state, Renderer &renderer, bool &wasCapture) {
     
     // Convert screen coordinates to board coordinates using 3D picking
     int row, col;
-    renderer.screenToBoard(mouseX, mouseY, row, col, isTealActive);
+    renderer.screenToBoard(state, mouseX, mouseY, row, col, isTealActive);
     if (row == -1 || col == -1) return false;
 
     Piece clicked = state.board[row][col];
@@ -38,6 +94,7 @@ bool handleClick(GameState &state, Renderer &renderer, bool &wasCapture) {
         if (isOwnPiece) {
             state.selectedRow = row;
             state.selectedCol = col;
+            path.clear();
         }
         return false;
     }
@@ -48,25 +105,59 @@ bool handleClick(GameState &state, Renderer &renderer, bool &wasCapture) {
     if (isOwnPiece) {
         state.selectedRow = row;
         state.selectedCol = col;
+        path.clear();
         return false;
     }
 
-    // Try to move
-    wasCapture = false;
-    if (applyMove(state, state.selectedRow, state.selectedCol, row, col, wasCapture)) {
+    // Try to move along the squares clicked so far
+    path.landings.push_back(squareIndex(row, col));
+    PathMatch match = applyMovePath(state, squareIndex(state.selectedRow, state.selectedCol),
+                                    path.landings.data(), static_cast<int>(path.landings.size()),
+                                    wasCapture, &played);
+    path.ambiguous = match == PathMatch::Ambiguous;
+    if (match == PathMatch::Played) {
         state.selectedRow = -1;
         state.selectedCol = -1;
+        path.clear();
         return true;
     }
-
+    if (match != PathMatch::Partial) {
+        path.landings.pop_back();
+    }
     return false;
 }
 
 int main(int argc, char *argv[]) {
-    (void)argc;
-    (void)argv;
+    // --stats shows the AI's search statistics in the sidebar (S toggles them in game);
+    // --stats-log FILE appends them to FILE as one JSON line per AI move;
+    // --continuous redraws every frame instead of only when something changed;
+    // --record FILE appends the game to FILE in the compact game record format;
+    // --no-ponder stops the AI from searching while the human thinks.
+    bool showStats = false;
+    bool continuous = false;
+    bool ponder = true;
+    const char *statsLogPath = nullptr;
+    const char *recordPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            showStats = true;
+        } else if (std::strcmp(argv[i], "--continuous") == 0) {
+            continuous = true;
+        } else if (std::strcmp(argv[i], "--no-ponder") == 0) {
+            ponder = false;
+        } else if (std::strcmp(argv[i], "--stats-log") == 0 && i + 1 < argc) {
+            statsLogPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--stats] [--stats-log FILE] [--record FILE] [--continuous] [--no-ponder]\n";
+            return 1;
+        }
+    }
 
-    // Initialize renderer (handles Raylib window and 3D rendering)
+    // Initialize renderer (handles Raylib window and 3D rendering). The meshes and the
+    // sounds load on worker threads so the menu can show straight away.
     Renderer renderer;
     if (!renderer.initialize()) {
         return 1;
@@ -80,8 +171,15 @@ int main(int argc, char *argv[]) {
     int menuSelection = -1;
     bool showingMenu = true;
     
+    bool menuShown = false;
     while (showingMenu && !renderer.shouldClose()) {
+        soundManager.update();
+        renderer.finishLoading();
         menuSelection = renderer.renderDifficultyMenu(static_cast<int>(selectedDifficulty));
+        if (!menuShown) {
+            markStartup("first menu frame");
+            menuShown = true;
+        }
         
         if (menuSelection >= 0 && menuSelection <= 2) {
             selectedDifficulty = static_cast<AIDifficulty>(menuSelection);
@@ -93,17 +191,76 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
+    // Usually long done while the menu was up.
+    renderer.waitForAssets();
+
     GameState state;
     initBoard(state);
 
-    CheckersAI ai(selectedDifficulty);
+    // Search on every core; helpers share the AI's transposition table (Lazy SMP).
+    int aiThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    CheckersAI ai(selectedDifficulty, aiThreads);
+    if (ai.loadTablebase("assets/endgame.tb")) {
+        std::cout << "Using endgame tablebase for up to " << ai.tablebasePieces() << " pieces\n";
+    }
+    if (ai.loadOpeningBook("assets/opening.book")) {
+        std::cout << "Using opening book with " << ai.openingBookSize() << " moves\n";
+    }
+    if (ai.loadEvalWeights("assets/eval.cfg")) {
+        std::cout << "Using evaluation weights from assets/eval.cfg\n";
+    }
+    markStartup("AI ready");
+    std::ofstream statsLog;
+    if (statsLogPath) {
+        statsLog.open(statsLogPath, std::ios::app);
+        if (statsLog) {
+            ai.setStatsLog(&statsLog);
+        } else {
+            std::cerr << "Cannot write " << statsLogPath << "\n";
+        }
+    }
+    GameRecordWriter recordWriter;
+    if (recordPath && !recordWriter.open(recordPath)) {
+        std::cerr << "Cannot write " << recordPath << "\n";
+    }
+    GameRecord gameRecord;      // moves of the game so far
+    bool gameRecorded = false;  // whether the finished game has been written
+
+    SearchStats lastStats;  // statistics of the AI's latest move, shown in the sidebar
+    unsigned statsVersion = 0;  // bumped when lastStats is replaced
+    std::future<AIMove> aiMove;  // pending AI search, valid while the AI is thinking
     GameResult result = GameResult::Ongoing;
     bool showPopup = false;
+    PendingPath pendingPath;    // jump the human is entering square by square
+    bool ponderPaused = false;  // pondering stopped while the window is in the background
+
+    FrameKey drawnKey;        // what the last drawn frame showed
+    int pendingRedraws = 1;   // frames still to draw before the screen is up to date
+    bool gameShown = false;   // whether the first game frame has been drawn
+    bool startupReported = false;
 
     bool running = true;
     while (running && !renderer.shouldClose()) {
+        // Each pass of the loop is one frame; mark where the previous one ended.
+        PROFILE_FRAME();
+        soundManager.update();
+
+        // Pondering would keep the cores busy for a player who has switched away, so
+        // it stops while the window is in the background and restarts on return.
+        bool inBackground = !IsWindowFocused() || IsWindowMinimized();
+        if (inBackground && ai.isPondering()) {
+            ai.stopPondering();
+            ponderPaused = true;
+        } else if (!inBackground && ponderPaused) {
+            ponderPaused = false;
+            if (result == GameResult::Ongoing && !aiMove.valid() && state.currentPlayer == TealMan) {
+                ai.startPondering(state);
+            }
+        }
+
         // Check if current player has no valid moves (they lose immediately)
-        if (result == GameResult::Ongoing) {
+        if (result == GameResult::Ongoing && !aiMove.valid()) {
+            PROFILE_SCOPE("winCheck");
             int tealCount = 0, purpleCount = 0;
             countPieces(state, tealCount, purpleCount);
             
@@ -124,64 +281,150 @@ int main(int argc, char *argv[]) {
         }
         
         // Handle input
+        if (IsKeyPressed(KEY_S)) {
+            showStats = !showStats;
+        }
         if (renderer.isMouseButtonPressed()) {
+            PROFILE_SCOPE("input");
             if (showPopup) {
                 // Handle popup clicks (simplified - just close on click for now)
                 // In a full implementation, you'd check button bounds
                 showPopup = false;
-            } else if (result == GameResult::Ongoing && state.currentPlayer == TealMan) {
+            } else if (result == GameResult::Ongoing && state.currentPlayer == TealMan &&
+                       !aiMove.valid()) {
                 bool humanCapture = false;
-                bool movedByHuman = handleClick(state, renderer, humanCapture);
+                Move humanMove;
+                bool movedByHuman = handleClick(state, renderer, pendingPath, humanCapture, humanMove);
                 if (movedByHuman) {
+                    gameRecord.append(humanMove);
                     if (!humanCapture)
                         soundManager.playMove();
                     else
                         soundManager.playCapture();
                     
                     // After human move, check if AI has any pieces or moves.
-                    int tealCount = 0, purpleCount = 0;
-                    countPieces(state, tealCount, purpleCount);
-                    if (purpleCount == 0 || !hasAnyMoves(state, PurpleMan)) {
+                    bool purpleStuck = false;
+                    {
+                        PROFILE_SCOPE("winCheck");
+                        int tealCount = 0, purpleCount = 0;
+                        countPieces(state, tealCount, purpleCount);
+                        purpleStuck = purpleCount == 0 || !hasAnyMoves(state, PurpleMan);
+                    }
+                    if (purpleStuck) {
+                        ai.stopPondering();
                         result = GameResult::TealWin;
                         soundManager.playWin();
                         showPopup = true;
                         continue;
                     }
 
-                    // Switch to AI (Purple)
-                    state.currentPlayer = PurpleMan;
-
-                    int sr, sc, tr, tc;
-                    if (ai.chooseMove(state, sr, sc, tr, tc)) {
-                        bool aiCapture = false;
-                        applyMove(state, sr, sc, tr, tc, aiCapture);
-                        if (!aiCapture)
-                            soundManager.playMove();
-                        else
-                            soundManager.playCapture();
-                    }
-
-                    state.selectedRow = -1;
-                    state.selectedCol = -1;
-                    
-                    // After AI move, check if player has any pieces or moves.
-                    countPieces(state, tealCount, purpleCount);
-                    if (tealCount == 0 || !hasAnyMoves(state, TealMan)) {
-                        result = GameResult::PurpleWin;
-                        soundManager.playLose();
-                        showPopup = true;
-                    } else {
-                        state.currentPlayer = TealMan;
-                    }
+                    // Switch to AI (Purple). The AI thinks in the background while
+                    // the loop keeps rendering; its move is picked up below. The
+                    // displayed state keeps Teal's camera until that move lands.
+                    // If the AI pondered this very position, it answers at once.
+                    GameState aiTurn = state;
+                    aiTurn.currentPlayer = PurpleMan;
+                    aiMove = ai.startThinking(aiTurn);
                 }
             }
         }
 
+        // Apply the AI's move once its search has finished.
+        if (aiMove.valid() &&
+            aiMove.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            PROFILE_SCOPE("applyAIMove");
+            AIMove chosen = aiMove.get();
+            lastStats = std::move(chosen.stats);
+            ++statsVersion;
+            if (chosen.found) {
+                // Play the chosen move itself: a jump sequence is not identified by its
+                // end squares alone.
+                makeMove(state, chosen.move);
+                gameRecord.append(chosen.move);
+                if (!chosen.move.isCapture())
+                    soundManager.playMove();
+                else
+                    soundManager.playCapture();
+            }
+
+            state.selectedRow = -1;
+            state.selectedCol = -1;
+
+            // After AI move, check if player has any pieces or moves.
+            int tealCount = 0, purpleCount = 0;
+            countPieces(state, tealCount, purpleCount);
+            if (tealCount == 0 || !hasAnyMoves(state, TealMan)) {
+                result = GameResult::PurpleWin;
+                soundManager.playLose();
+                showPopup = true;
+            } else if (ponder) {
+                // Think about the reply the AI expects while the human makes it.
+                ai.startPondering(state);
+            }
+        }
+
+        // Append the game to the record file once it is decided.
+        if (result != GameResult::Ongoing && !gameRecorded) {
+            gameRecord.setOutcome(result == GameResult::TealWin ? GameOutcome::TealWin : GameOutcome::PurpleWin);
+            if (recordWriter.isOpen()) {
+                recordWriter.write(gameRecord);
+            }
+            gameRecorded = true;
+        }
+
+        // Report how startup went once the game is up and every asset has arrived.
+        if (gameShown && !startupReported && soundManager.isLoaded()) {
+            printStartupTimings(std::cout);
+            startupReported = true;
+        }
+
+        // Highlight the square under the pointer while the human may click one. The
+        // lookup projects a few dozen piece outlines and reads the board's pixel map,
+        // so it is cheap enough to do every frame.
+        int hoverRow = -1, hoverCol = -1;
+        if (!showPopup && result == GameResult::Ongoing && state.currentPlayer == TealMan &&
+            !aiMove.valid()) {
+            Vector2 mousePos = renderer.getMousePosition();
+            renderer.screenToBoard(state, (int)mousePos.x, (int)mousePos.y, hoverRow, hoverCol, true);
+        }
+        renderer.setHoveredSquare(hoverRow, hoverCol);
+        renderer.setMovePath(pendingPath.landings, pendingPath.ambiguous);
+
+        // Skip drawing while nothing on screen would change. After a change, draw
+        // twice so both buffers of the swap chain hold the new picture.
+        FrameKey key{state, showPopup, result, showStats ? &lastStats : nullptr, statsVersion,
+                     hoverRow, hoverCol, pendingPath.landings.size(), pendingPath.ambiguous,
+                     IsWindowFocused(), IsWindowMinimized()};
+        if (key != drawnKey || IsWindowResized()) {
+            drawnKey = key;
+            pendingRedraws = 2;
+        }
+        if (!continuous && pendingRedraws == 0) {
+            if (aiMove.valid() || soundManager.needsUpdate()) {
+                // Keep checking for the AI's move, and feeding streamed sound, at the frame rate.
+                WaitTime(1.0 / 60.0);
+                PollInputEvents();
+            } else {
+                // Sleep until the next input event.
+                EnableEventWaiting();
+                PollInputEvents();
+                DisableEventWaiting();
+            }
+            continue;
+        }
+        if (pendingRedraws > 0) --pendingRedraws;
+
         // Render game
+        renderer.setSearchStats(key.stats);
         renderer.renderGame(state);
+        if (!gameShown) {
+            markStartup("first game frame");
+            gameShown = true;
+        }
         
         // Render popup overlay if needed
         if (showPopup) {
+            PROFILE_SCOPE("renderPopup");
             renderer.beginDrawing();
             // Draw semi-transparent overlay
             DrawRectangle(0, 0, 800, 800, (Color){0, 0, 0, 180});
@@ -223,10 +466,15 @@ int main(int argc, char *argv[]) {
                 if (mousePos.x >= popupX + 50 && mousePos.x <= popupX + 50 + btnW &&
                     mousePos.y >= btnY && mousePos.y <= btnY + btnH) {
                     // New Game
+                    ai.stopPondering();
+                    ponderPaused = false;
+                    pendingPath.clear();
                     initBoard(state);
                     state.currentPlayer = TealMan;
                     state.selectedRow = state.selectedCol = -1;
                     result = GameResult::Ongoing;
+                    gameRecord.clear();
+                    gameRecorded = false;
                     showPopup = false;
                 } else if (mousePos.x >= popupX + 210 && mousePos.x <= popupX + 210 + btnW &&
                            mousePos.y >= btnY && mousePos.y <= btnY + btnH) {
@@ -239,5 +487,22 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    // Don't wait for a full search budget when the window is closed mid-think.
+    if (aiMove.valid()) {
+        ai.stopThinking();
+        aiMove.wait();
+    }
+
+    // A game left before it was decided is kept too, marked unfinished.
+    if (recordWriter.isOpen() && !gameRecorded && gameRecord.plyCount() > 0) {
+        recordWriter.write(gameRecord);
+    }
+
+#if defined(CHECKERS_PROFILE)
+    if (writeChromeTrace("checkers_trace.json")) {
+        std::cout << "Wrote profile trace to checkers_trace.json\n";
+    }
+#endif
+
     return 0;
 }
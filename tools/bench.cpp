@@ -0,0 +1,592 @@
+// Microbenchmarks for the rules and the AI over a fixed corpus of positions.
+// Prints ns/op and heap allocations/op as JSON and can diff a run against a
+// stored baseline (see bench/baseline.json). With --corpus it also replays a
+// regression corpus of deterministic searches (see bench/corpus.txt) and checks
+// each still finds the same best move with the same node count.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BatchEvaluator.h"
+#include "Bitboard.h"
+#include "CheckersAI.h"
+#include "Notation.h"
+#include "SearchEngine.h"
+
+// Every heap allocation made by the process goes through these, so a benchmark can
+// report how many allocations one operation performs.
+namespace {
+std::atomic<std::uint64_t> allocationCount{0};
+}
+
+// Where GCC inlines only one side of a replaced new/delete pair it reports malloc or
+// free as a mismatched allocation, so all of them are kept out of line.
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void *operator new[](std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void *p) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete[](void *p) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief One position of the benchmark corpus.
+ */
+struct CorpusEntry {
+    const char *category;
+    const char *fen;
+};
+
+// Openings, middlegames and king endgames taken from AI-vs-AI games.
+constexpr CorpusEntry CORPUS[] = {
+    {"opening", "B:W21,22,23,24,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,11,12"},
+    {"opening", "B:W18,20,21,22,24,25,26,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,15,19"},
+    {"opening", "B:W19,21,22,23,25,26,27,28,29,30,31:B1,2,3,4,5,6,8,9,15,16,20"},
+    {"opening", "B:W12,18,21,22,25,26,28,29,30,31,32:B1,2,3,4,5,6,7,9,10,11,19"},
+    {"middlegame", "B:W12,19,20,21,22,24,25,26,29,30:B1,3,4,5,7,10,11,13,15,K32"},
+    {"middlegame", "B:W8,12,15,21,22,25,28,29,30:B1,2,3,4,5,6,9,27"},
+    {"middlegame", "B:W6,12,18,21,23,25,26,27,29,30:B3,4,5,7,10,14,16,20"},
+    {"middlegame", "B:W13,20,22,26,27,28,29:B1,2,3,4,7,16,17"},
+    {"endgame", "W:WK3,5,8,K10:B1,19,K26,K28"},
+    {"endgame", "W:WK3,K9,10,13,14,17,19,20:B1,4,5,K24"},
+    {"endgame", "B:WK14,K23,K30:BK5,K10,K19"},
+    {"endgame", "W:W9,21,K24:B4,12,14,K28"},
+};
+
+const char *const CATEGORIES[] = {"opening", "middlegame", "endgame"};
+
+/**
+ * @brief A corpus position in both representations, with its legal moves.
+ */
+struct Position {
+    GameState state;
+    Bitboard bb;
+    Piece side = TealMan;
+    MoveList moves;
+};
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+    std::uint64_t ops = 0;
+};
+
+struct RunConfig {
+    int minTimeMs = 200;         ///< Keep doubling the op count until a run lasts this long
+    int hardDepth = 8;           ///< Fixed depth for Hard so its cost does not depend on the clock
+    double threshold = 10.0;     ///< Percent change reported as a regression by --compare
+    std::string filter;          ///< Only run benchmarks whose name contains this
+    std::string outPath;         ///< Write JSON here instead of stdout
+    std::string comparePath;     ///< Baseline to diff against
+    std::string corpusPath;      ///< Regression corpus to check, empty for none
+    bool writeCorpus = false;    ///< Record this build's results in the corpus instead of checking them
+};
+
+// Results are folded into this so the compiler cannot drop the benchmarked calls.
+volatile std::uint64_t sink = 0;
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_bench [options]\n"
+        "  --min-time MS     minimum duration of each benchmark (default 200)\n"
+        "  --hard-depth N    search depth used for chooseMove/hard (default 8)\n"
+        "  --filter TEXT     only run benchmarks whose name contains TEXT\n"
+        "  --out FILE        write the JSON results to FILE instead of stdout\n"
+        "  --compare FILE    diff the results against a baseline JSON file\n"
+        "  --threshold PCT   change reported as a regression by --compare (default 10)\n"
+        "  --corpus FILE     check the searches of a regression corpus and time them\n"
+        "  --write-corpus    record the corpus searches' results in FILE instead\n"
+        "Exits with status 1 if a benchmark regressed or a corpus search changed.\n";
+}
+
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (arg == "--write-corpus") { config.writeCorpus = true; continue; }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--min-time") config.minTimeMs = std::atoi(value);
+        else if (arg == "--hard-depth") config.hardDepth = std::atoi(value);
+        else if (arg == "--filter") config.filter = value;
+        else if (arg == "--out") config.outPath = value;
+        else if (arg == "--compare") config.comparePath = value;
+        else if (arg == "--threshold") config.threshold = std::atof(value);
+        else if (arg == "--corpus") config.corpusPath = value;
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.minTimeMs < 1 || config.hardDepth < 1) {
+        std::cerr << "--min-time and --hard-depth must be positive\n";
+        return false;
+    }
+    if (config.writeCorpus && config.corpusPath.empty()) {
+        std::cerr << "--write-corpus needs --corpus FILE\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads the corpus positions of one category.
+ */
+std::vector<Position> loadCategory(const char *category) {
+    std::vector<Position> positions;
+    for (const CorpusEntry &entry : CORPUS) {
+        if (std::string(entry.category) != category) continue;
+        Position pos;
+        if (!parseFen(entry.fen, pos.bb, pos.side)) {
+            std::cerr << "Bad corpus FEN: " << entry.fen << "\n";
+            std::exit(1);
+        }
+        fromBitboard(pos.bb, pos.state);
+        pos.state.currentPlayer = pos.side;
+        generateMoves(pos.bb, pos.side, pos.moves);
+        positions.push_back(pos);
+    }
+    return positions;
+}
+
+/**
+ * @brief Times a cheap operation by running it in a tight loop.
+ * The op count doubles until one run lasts at least minTimeMs; that run is reported.
+ * @param op Performs operation number i; a template parameter so it is inlined into the loop
+ */
+template <typename Op>
+BenchResult measureLoop(const std::string &name, int minTimeMs, Op op) {
+    BenchResult result;
+    result.name = name;
+    for (std::uint64_t ops = 64;; ops *= 2) {
+        std::uint64_t allocsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < ops; ++i) {
+            op(i);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        std::uint64_t allocs = allocationCount.load(std::memory_order_relaxed) - allocsBefore;
+
+        if (ns >= minTimeMs * 1e6 || ops >= (std::uint64_t{1} << 40)) {
+            result.nsPerOp = ns / ops;
+            result.allocsPerOp = static_cast<double>(allocs) / ops;
+            result.ops = ops;
+            return result;
+        }
+    }
+}
+
+/**
+ * @brief Times an expensive operation one call at a time, excluding per-call setup.
+ * Runs until the timed calls add up to minTimeMs, and at least once per position.
+ * @param setup Prepares operation number i (not timed)
+ * @param op Performs operation number i
+ */
+BenchResult measureEach(const std::string &name, int minTimeMs, std::uint64_t minOps,
+                        const std::function<void(std::uint64_t)> &setup,
+                        const std::function<void(std::uint64_t)> &op) {
+    BenchResult result;
+    result.name = name;
+    double totalNs = 0;
+    std::uint64_t totalAllocs = 0;
+    std::uint64_t ops = 0;
+    while (ops < minOps || totalNs < minTimeMs * 1e6) {
+        setup(ops);
+        std::uint64_t allocsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        op(ops);
+        totalNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        totalAllocs += allocationCount.load(std::memory_order_relaxed) - allocsBefore;
+        ++ops;
+    }
+    result.nsPerOp = totalNs / ops;
+    result.allocsPerOp = static_cast<double>(totalAllocs) / ops;
+    result.ops = ops;
+    return result;
+}
+
+/**
+ * @brief Runs every benchmark on one category of the corpus.
+ */
+void runCategory(const char *category, const RunConfig &config, std::vector<BenchResult> &results) {
+    const std::vector<Position> positions = loadCategory(category);
+    const std::uint64_t count = positions.size();
+    const std::string suffix = std::string("/") + category;
+    auto wanted = [&](const std::string &name) {
+        return config.filter.empty() || (name + suffix).find(config.filter) != std::string::npos;
+    };
+    auto at = [&](std::uint64_t i) -> const Position & { return positions[i % count]; };
+
+    if (wanted("applyMove")) {
+        // Each op copies the GameState so every call sees the same position.
+        results.push_back(measureLoop("applyMove" + suffix, config.minTimeMs, [&](std::uint64_t i) {
+            const Position &pos = at(i);
+            if (pos.moves.empty()) return;
+            const Move &m = pos.moves[static_cast<int>((i / count) % pos.moves.size())];
+            GameState copy = pos.state;
+            bool wasCapture = false;
+            sink = sink + applyMove(copy, squareRow(m.from), squareCol(m.from),
+                                    squareRow(m.to), squareCol(m.to), wasCapture);
+        }));
+    }
+    if (wanted("hasAnyMoves")) {
+        results.push_back(measureLoop("hasAnyMoves" + suffix, config.minTimeMs, [&](std::uint64_t i) {
+            sink = sink + hasAnyMoves(at(i).state, at(i).side);
+        }));
+    }
+    if (wanted("countPieces")) {
+        results.push_back(measureLoop("countPieces" + suffix, config.minTimeMs, [&](std::uint64_t i) {
+            int teal = 0, purple = 0;
+            countPieces(at(i).state, teal, purple);
+            sink = sink + teal + purple;
+        }));
+    }
+    if (wanted("generateMoves")) {
+        results.push_back(measureLoop("generateMoves" + suffix, config.minTimeMs, [&](std::uint64_t i) {
+            MoveList moves;
+            generateMoves(at(i).bb, at(i).side, moves);
+            sink = sink + moves.size();
+        }));
+    }
+    if (wanted("makeUnmake")) {
+        results.push_back(measureLoop("makeUnmake" + suffix, config.minTimeMs, [&](std::uint64_t i) {
+            const Position &pos = at(i);
+            if (pos.moves.empty()) return;
+            const Move &m = pos.moves[static_cast<int>((i / count) % pos.moves.size())];
+            Bitboard bb = pos.bb;
+            UndoRecord undo = makeMove(bb, m);
+            sink = sink + bb.teal;
+            unmakeMove(bb, m, undo);
+        }));
+    }
+    if (wanted("evaluatePosition")) {
+        results.push_back(measureLoop("evaluatePosition" + suffix, config.minTimeMs, [&](std::uint64_t i) {
+            sink = sink + static_cast<std::uint64_t>(evaluatePosition(at(i).bb, at(i).side));
+        }));
+    }
+    if (wanted("evaluateBatch64")) {
+        // One op scores 64 leaves at once; compare with 64 x evaluatePosition.
+        constexpr int BATCH = 64;
+        std::array<Bitboard, BATCH> boards;
+        std::array<Piece, BATCH> sides;
+        std::array<int, BATCH> scores;
+        for (int i = 0; i < BATCH; ++i) {
+            boards[i] = at(i).bb;
+            sides[i] = at(i).side;
+        }
+        const BatchEvaluator batch;
+        results.push_back(measureLoop("evaluateBatch64" + suffix, config.minTimeMs, [&](std::uint64_t) {
+            batch.evaluate(boards.data(), sides.data(), BATCH, scores.data());
+            sink = sink + static_cast<std::uint64_t>(scores[0]);
+        }));
+    }
+
+    // The AI keeps its table between moves; clear it before every call so each
+    // search starts cold and the numbers do not depend on what ran before. A small
+    // table keeps the untimed clearing cheap and is ample for these depths.
+    const std::pair<const char *, AIDifficulty> levels[] = {
+        {"chooseMove/easy", AIDifficulty::Easy},
+        {"chooseMove/medium", AIDifficulty::Medium},
+        {"chooseMove/hard", AIDifficulty::Hard},
+    };
+    for (const auto &level : levels) {
+        if (!wanted(level.first)) continue;
+        CheckersAI ai(level.second);
+        ai.setHashSizeMb(1);
+        if (level.second == AIDifficulty::Hard) {
+            SearchLimits limits = ai.searchLimits();
+            limits.maxDepth = config.hardDepth;
+            limits.timeLimitMs = 0;
+            ai.setSearchLimits(limits);
+        }
+        results.push_back(measureEach(level.first + suffix, config.minTimeMs, count,
+            [&](std::uint64_t) { ai.clearHash(); },
+            [&](std::uint64_t i) {
+                Move move;
+                sink = sink + ai.chooseMove(at(i).state, move);
+            }));
+    }
+}
+
+/**
+ * @brief One search of the regression corpus and the result it must produce.
+ */
+struct RegressionEntry {
+    std::string fen;
+    int depth = 0;
+    std::string bestMove;     ///< Expected best move in PDN notation
+    std::uint64_t nodes = 0;  ///< Expected node count
+};
+
+const char *const CORPUS_HEADER =
+    "# Regression corpus for checkers_bench --corpus. Each line is a position (FEN), the\n"
+    "# depth a deterministic Hard search runs to, and the best move and node count it\n"
+    "# must produce. Re-record with make bench-baseline only when a change is meant to\n"
+    "# alter the search.\n";
+
+/**
+ * @brief Reads a regression corpus; blank lines and lines starting with # are skipped.
+ * @param entries Output parameter receiving the entries in file order
+ * @return true if the file was read and every line is valid
+ */
+bool readCorpus(const std::string &path, std::vector<RegressionEntry> &entries) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot read corpus " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        RegressionEntry entry;
+        Bitboard bb;
+        Piece side;
+        if (!(fields >> entry.fen >> entry.depth >> entry.bestMove >> entry.nodes) ||
+            !parseFen(entry.fen, bb, side) || entry.depth < 1) {
+            std::cerr << "Bad corpus line: " << line << "\n";
+            return false;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a regression corpus in the format readCorpus() reads.
+ * @return true if the file was written
+ */
+bool writeCorpus(const std::string &path, const std::vector<RegressionEntry> &entries) {
+    std::ofstream out(path);
+    out << CORPUS_HEADER;
+    for (const RegressionEntry &entry : entries) {
+        out << entry.fen << ' ' << entry.depth << ' ' << entry.bestMove << ' ' << entry.nodes << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Searches every corpus position with a fresh, seeded, deterministic Hard AI and
+ * compares the best move and node count with the expected ones.
+ * @param entries The corpus; its expectations are replaced with this build's results
+ *        if record is true
+ * @param record Whether to record the results instead of checking them
+ * @param results Receives the searches' speed as ns per node, so --compare catches nps drops
+ * @return Number of searches whose move or node count differs from the corpus
+ */
+int runCorpus(std::vector<RegressionEntry> &entries, bool record, std::vector<BenchResult> &results) {
+    // Node counts depend on the table size, so it is fixed here rather than defaulted.
+    CheckersAI ai(AIDifficulty::Hard, 1, 0);
+    ai.setDeterministic(true);
+    ai.setHashSizeMb(16);
+    int mismatches = 0;
+    double totalMs = 0;
+    std::uint64_t totalNodes = 0;
+    for (RegressionEntry &entry : entries) {
+        Bitboard bb;
+        Piece side;
+        parseFen(entry.fen, bb, side);
+        GameState state;
+        fromBitboard(bb, state);
+        state.currentPlayer = side;
+
+        SearchLimits limits;
+        limits.maxDepth = entry.depth;
+        ai.setSearchLimits(limits);
+        ai.clearHash();
+        AIMove move = ai.chooseMove(state);
+        std::string best = move.found ? moveToString(move.move) : "-";
+        totalMs += move.stats.timeMs;
+        totalNodes += move.stats.nodes;
+
+        if (record) {
+            entry.bestMove = best;
+            entry.nodes = move.stats.nodes;
+        } else if (best != entry.bestMove || move.stats.nodes != entry.nodes) {
+            std::fprintf(stderr, "Corpus changed: %s depth %d: %s, %llu nodes (expected %s, %llu nodes)\n",
+                         entry.fen.c_str(), entry.depth, best.c_str(),
+                         static_cast<unsigned long long>(move.stats.nodes), entry.bestMove.c_str(),
+                         static_cast<unsigned long long>(entry.nodes));
+            ++mismatches;
+        }
+    }
+    BenchResult result;
+    result.name = "searchCorpus/node";
+    result.ops = totalNodes;
+    result.nsPerOp = totalNodes ? totalMs * 1e6 / totalNodes : 0.0;
+    std::fprintf(stderr, "Corpus: %zu searches, %llu nodes, %.2f Mnps, %d changed\n", entries.size(),
+                 static_cast<unsigned long long>(totalNodes), totalMs > 0 ? totalNodes / totalMs / 1000.0 : 0.0,
+                 mismatches);
+    results.push_back(result);
+    return mismatches;
+}
+
+/**
+ * @brief Checks or, with --write-corpus, records the regression corpus.
+ * @param results Receives the corpus searches' speed
+ * @return Number of changed searches, -1 if the corpus cannot be read or written
+ */
+int checkCorpus(const RunConfig &config, std::vector<BenchResult> &results) {
+    std::vector<RegressionEntry> entries;
+    if (!readCorpus(config.corpusPath, entries)) {
+        return -1;
+    }
+    int mismatches = runCorpus(entries, config.writeCorpus, results);
+    if (config.writeCorpus) {
+        if (!writeCorpus(config.corpusPath, entries)) {
+            std::cerr << "Cannot write " << config.corpusPath << "\n";
+            return -1;
+        }
+        std::fprintf(stderr, "Recorded %zu corpus searches in %s\n", entries.size(), config.corpusPath.c_str());
+    }
+    return mismatches;
+}
+
+std::string toJson(const std::vector<BenchResult> &results) {
+    std::ostringstream out;
+    out << "{\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f, \"ops\": %llu}%s\n",
+                      results[i].name.c_str(), results[i].nsPerOp, results[i].allocsPerOp,
+                      static_cast<unsigned long long>(results[i].ops), i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+/**
+ * @brief Reads a results file written by toJson().
+ * @return Results keyed by benchmark name, empty if the file cannot be read
+ */
+std::map<std::string, BenchResult> readJson(const std::string &path) {
+    std::map<std::string, BenchResult> results;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        char name[128];
+        BenchResult r;
+        if (std::sscanf(line.c_str(), " {\"name\": \"%127[^\"]\", \"ns_per_op\": %lf, \"allocs_per_op\": %lf",
+                        name, &r.nsPerOp, &r.allocsPerOp) == 3) {
+            r.name = name;
+            results[r.name] = r;
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Prints how each result changed relative to the baseline.
+ * @return Number of benchmarks that got slower or started allocating more
+ */
+int compare(const std::vector<BenchResult> &results, const std::map<std::string, BenchResult> &baseline,
+            double threshold) {
+    int regressions = 0;
+    std::fprintf(stderr, "%-30s %12s %12s %8s %10s\n", "benchmark", "base ns/op", "ns/op", "change", "allocs/op");
+    for (const BenchResult &r : results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            std::fprintf(stderr, "%-30s %12s %12.2f %8s %10.3f  new\n", r.name.c_str(), "-", r.nsPerOp, "-",
+                         r.allocsPerOp);
+            continue;
+        }
+        const BenchResult &base = it->second;
+        double change = base.nsPerOp > 0 ? 100.0 * (r.nsPerOp - base.nsPerOp) / base.nsPerOp : 0.0;
+        const char *verdict = "";
+        // chooseMove's op count follows the clock, so its allocs/op drift a little with
+        // the mix of positions; an extra allocation in one op out of twenty is not noise.
+        if (change > threshold || r.allocsPerOp > base.allocsPerOp + 0.05) {
+            verdict = "  REGRESSION";
+            ++regressions;
+        } else if (change < -threshold) {
+            verdict = "  faster";
+        }
+        std::fprintf(stderr, "%-30s %12.2f %12.2f %+7.1f%% %10.3f%s\n", r.name.c_str(), base.nsPerOp, r.nsPerOp,
+                     change, r.allocsPerOp, verdict);
+    }
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    for (const char *category : CATEGORIES) {
+        runCategory(category, config, results);
+    }
+
+    int failures = 0;
+    if (!config.corpusPath.empty()) {
+        failures = checkCorpus(config, results);
+        if (failures < 0) return 1;
+    }
+
+    std::string json = toJson(results);
+    if (config.outPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(config.outPath);
+        if (!out) {
+            std::cerr << "Cannot write " << config.outPath << "\n";
+            return 1;
+        }
+        out << json;
+    }
+
+    if (!config.comparePath.empty()) {
+        std::map<std::string, BenchResult> baseline = readJson(config.comparePath);
+        if (baseline.empty()) {
+            std::cerr << "No baseline results in " << config.comparePath << "\n";
+            return 1;
+        }
+        int regressions = compare(results, baseline, config.threshold);
+        std::fprintf(stderr, "%d regression(s) beyond %.1f%%\n", regressions, config.threshold);
+        failures += regressions;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+// Game record inspector: scans a file written by checkers_selfplay --record or the
+// game's --record option, summarizes it, exports it as PDN and shows any position
+// of any game.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Bitboard.h"
+#include "GameRecord.h"
+#include "Notation.h"
+
+namespace {
+
+struct RunConfig {
+    std::string path;
+    std::string pdnPath;   ///< Export every game here, empty for none
+    bool verify = false;   ///< Replay every game to check its moves are legal
+    int showGame = -1;     ///< Game to print the position of, -1 for none
+    int showPly = 0;       ///< Ply of showGame to print
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_games FILE [options]\n"
+        "  --pdn OUT          export every game as PDN text\n"
+        "  --verify           replay every game and report illegal or corrupt ones\n"
+        "  --show GAME:PLY    print the position of game GAME (from 1) after PLY moves\n";
+}
+
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (arg == "--verify") { config.verify = true; continue; }
+        if (arg.rfind("--", 0) != 0) {
+            if (!config.path.empty()) {
+                std::cerr << "Unexpected argument: " << arg << "\n";
+                return false;
+            }
+            config.path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--pdn") config.pdnPath = value;
+        else if (arg == "--show") {
+            if (std::sscanf(value, "%d:%d", &config.showGame, &config.showPly) != 2 || config.showGame < 1) {
+                std::cerr << "--show expects GAME:PLY, e.g. 3:20\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.path.empty()) {
+        std::cerr << "No game record file given\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    GameRecordReader reader;
+    if (!reader.open(config.path)) {
+        std::cerr << "Cannot open " << config.path << "\n";
+        return 1;
+    }
+    std::ofstream pdn;
+    if (!config.pdnPath.empty()) {
+        pdn.open(config.pdnPath);
+        if (!pdn) {
+            std::cerr << "Cannot write " << config.pdnPath << "\n";
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t games = 0, plies = 0, bytes = 0, invalid = 0;
+    std::uint64_t outcomes[4] = {};
+    GameRecord record;
+    GameReplay replay;
+    while (reader.next(record)) {
+        ++games;
+        plies += record.plyCount();
+        bytes += record.bytes().size();
+        ++outcomes[static_cast<int>(record.outcome())];
+
+        if (config.verify && !replay.load(record)) {
+            std::cerr << "Game " << games << " has a corrupt or illegal move\n";
+            ++invalid;
+        }
+        if (pdn.is_open()) {
+            pdn << toPdn(record, config.path, std::to_string(games));
+        }
+        if (static_cast<int>(games) == config.showGame) {
+            if (!replay.load(record)) {
+                std::cerr << "Game " << games << " cannot be replayed\n";
+                return 1;
+            }
+            replay.seek(config.showPly);
+            std::printf("Game %llu after %d of %d plies: %s\n", static_cast<unsigned long long>(games),
+                        replay.ply(), replay.plyCount(), toFen(replay.position(), replay.sideToMove()).c_str());
+            if (replay.ply() < replay.plyCount()) {
+                std::printf("Next move: %s\n", moveToString(replay.move(replay.ply())).c_str());
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("Games: %llu (Teal wins %llu, draws %llu, Purple wins %llu, unfinished %llu)\n",
+                static_cast<unsigned long long>(games), static_cast<unsigned long long>(outcomes[1]),
+                static_cast<unsigned long long>(outcomes[2]), static_cast<unsigned long long>(outcomes[3]),
+                static_cast<unsigned long long>(outcomes[0]));
+    std::printf("Plies: %llu, %.1f per game, %.2f bytes per move\n", static_cast<unsigned long long>(plies),
+                games ? static_cast<double>(plies) / games : 0.0,
+                plies ? static_cast<double>(bytes) / plies : 0.0);
+    std::printf("Scanned in %.3f s (%.0f games/s)\n", seconds, seconds > 0 ? games / seconds : 0.0);
+    if (config.showGame > static_cast<int>(games)) {
+        std::cerr << "There is no game " << config.showGame << "\n";
+        return 1;
+    }
+    if (config.verify) {
+        std::printf("Invalid games: %llu\n", static_cast<unsigned long long>(invalid));
+        if (invalid > 0) return 1;
+    }
+    if (pdn.is_open()) {
+        std::printf("Wrote PDN to %s\n", config.pdnPath.c_str());
+    }
+    return 0;
+}
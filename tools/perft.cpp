@@ -0,0 +1,254 @@
+// Perft: counts the leaf nodes of the move tree to a fixed depth. Checks the move
+// generator against published counts and measures its raw throughput.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bitboard.h"
+#include "GameLogic.h"
+#include "Notation.h"
+
+namespace {
+
+/**
+ * @brief Published perft counts for the starting position under standard
+ * (forced capture, multi-jump) rules, indexed by depth - 1.
+ */
+constexpr std::uint64_t START_REFERENCE[] = {
+    7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564, 85242128, 388623673,
+};
+constexpr int REFERENCE_DEPTH = sizeof(START_REFERENCE) / sizeof(START_REFERENCE[0]);
+
+/**
+ * @brief A position where the man on 15 has two jump sequences that share both end
+ * squares but capture different pieces: 15x24x31 and 15x22x31.
+ */
+constexpr const char *TWO_PATH_FEN = "B:W18,19,26,27:B15";
+
+struct RunConfig {
+    int depth = 7;
+    int threads = 1;
+    bool divide = false;
+    bool verify = false;
+    std::string fen = START_FEN;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_perft [options]\n"
+        "  --depth N      search depth in plies (default 7)\n"
+        "  --fen FEN      position to count from (default: start position)\n"
+        "  --threads N    split the root moves across N threads (default 1)\n"
+        "  --divide       print the count below each root move\n"
+        "  --verify       compare every depth up to N against the reference counts\n"
+        "                 for the start position and check that jump sequences with\n"
+        "                 the same end squares can be told apart; exits non-zero on\n"
+        "                 a mismatch\n";
+}
+
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--divide") { config.divide = true; continue; }
+        if (arg == "--verify") { config.verify = true; continue; }
+        if (arg == "--help" || arg == "-h") return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--depth") config.depth = std::atoi(value);
+        else if (arg == "--threads") config.threads = std::atoi(value);
+        else if (arg == "--fen") config.fen = value;
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.depth < 1 || config.threads < 1) {
+        std::cerr << "--depth and --threads must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Counts the leaves of the move tree below a position.
+ * Specialized per side, so the whole recursion runs without a colour test.
+ * Positions where the side to move is stuck before the horizon count zero.
+ * @tparam S The side to move
+ * @param bb The position, modified in place and restored before returning
+ * @param depth Remaining depth in plies (>= 1)
+ * @return Number of leaf nodes at exactly the given depth
+ */
+template <Side S>
+std::uint64_t perft(Bitboard &bb, int depth) {
+    MoveList moves;
+    generateMoves<S>(bb, moves);
+    if (depth == 1) {
+        return static_cast<std::uint64_t>(moves.size());
+    }
+
+    std::uint64_t nodes = 0;
+    for (const Move &move : moves) {
+        UndoRecord undo = makeMove<S>(bb, move);
+        nodes += perft<opposite(S)>(bb, depth - 1);
+        unmakeMove<S>(bb, move, undo);
+    }
+    return nodes;
+}
+
+/**
+ * @brief Runs perft with the root moves shared out between worker threads.
+ * @param root The position to count from
+ * @param side The side to move
+ * @param depth Depth in plies (>= 1)
+ * @param threads Number of worker threads
+ * @param rootMoves Output parameter for the root moves
+ * @param rootCounts Output parameter for the count below each root move
+ * @return Total number of leaf nodes
+ */
+std::uint64_t perftParallel(const Bitboard &root, Piece side, int depth, int threads,
+                            MoveList &rootMoves, std::vector<std::uint64_t> &rootCounts) {
+    generateMoves(root, side, rootMoves);
+    rootCounts.assign(rootMoves.size(), 1);
+    if (depth == 1) {
+        return static_cast<std::uint64_t>(rootMoves.size());
+    }
+
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        Bitboard bb = root;
+        for (int i = next.fetch_add(1); i < rootMoves.size(); i = next.fetch_add(1)) {
+            UndoRecord undo = makeMove(bb, rootMoves[i]);
+            rootCounts[i] = isTealPiece(side) ? perft<Side::Purple>(bb, depth - 1)
+                                              : perft<Side::Teal>(bb, depth - 1);
+            unmakeMove(bb, rootMoves[i], undo);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    std::uint64_t total = 0;
+    for (std::uint64_t count : rootCounts) {
+        total += count;
+    }
+    return total;
+}
+
+/**
+ * @brief Plays landing squares in TWO_PATH_FEN the way the GUI does.
+ * @param landings PDN numbers of the squares clicked after selecting the man on 15
+ * @param played Output parameter for the move, set when one was played
+ * @return How the squares matched
+ */
+PathMatch playTwoPathLandings(std::initializer_list<int> landings, Move &played) {
+    Bitboard bb;
+    Piece side = TealMan;
+    parseFen(TWO_PATH_FEN, bb, side);
+    GameState state;
+    fromBitboard(bb, state);
+    state.currentPlayer = side;
+
+    std::vector<int> squares;
+    for (int n : landings) {
+        squares.push_back(pdnToSquare(n));
+    }
+    bool wasCapture = false;
+    return applyMovePath(state, pdnToSquare(15), squares.data(), static_cast<int>(squares.size()),
+                         wasCapture, &played);
+}
+
+/**
+ * @brief Checks that two jump sequences with the same end squares can each be
+ * entered by their landing squares, and that the end squares alone are refused.
+ * @return true if every check passed
+ */
+bool checkJumpPaths() {
+    Move left, right, unused;
+    bool ok = playTwoPathLandings({31}, unused) == PathMatch::Ambiguous &&
+              playTwoPathLandings({24}, unused) == PathMatch::Partial &&
+              playTwoPathLandings({24, 31}, right) == PathMatch::Played &&
+              playTwoPathLandings({22, 31}, left) == PathMatch::Played &&
+              moveToString(right) == "15x24x31" && moveToString(left) == "15x22x31" &&
+              left.captured != right.captured;
+    std::printf("Jump paths: %s  %s\n", TWO_PATH_FEN, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    Bitboard root;
+    Piece side = TealMan;
+    if (!parseFen(config.fen, root, side)) {
+        std::cerr << "Invalid FEN: " << config.fen << "\n";
+        return 1;
+    }
+    bool isStart = toFen(root, side) == START_FEN;
+    if (config.verify && !isStart) {
+        std::cerr << "--verify needs the start position\n";
+        return 1;
+    }
+
+    std::printf("Position: %s\n", toFen(root, side).c_str());
+    std::printf("Threads: %d\n", config.threads);
+
+    bool mismatch = false;
+    for (int depth = (config.verify ? 1 : config.depth); depth <= config.depth; ++depth) {
+        MoveList rootMoves;
+        std::vector<std::uint64_t> rootCounts;
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t nodes = perftParallel(root, side, depth, config.threads, rootMoves, rootCounts);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (config.divide && depth == config.depth) {
+            for (int i = 0; i < rootMoves.size(); ++i) {
+                std::printf("  %-7s %llu\n", moveToString(rootMoves[i]).c_str(),
+                            static_cast<unsigned long long>(rootCounts[i]));
+            }
+        }
+
+        std::printf("depth %2d  nodes %14llu  time %8.3f s  %8.2f Mnps", depth,
+                    static_cast<unsigned long long>(nodes), seconds,
+                    seconds > 0 ? nodes / seconds / 1e6 : 0.0);
+        if (isStart && depth <= REFERENCE_DEPTH) {
+            bool ok = nodes == START_REFERENCE[depth - 1];
+            mismatch |= !ok;
+            if (ok) {
+                std::printf("  ok");
+            } else {
+                std::printf("  MISMATCH (expected %llu)",
+                            static_cast<unsigned long long>(START_REFERENCE[depth - 1]));
+            }
+        }
+        std::printf("\n");
+    }
+
+    if (config.verify) {
+        mismatch |= !checkJumpPaths();
+    }
+    return (config.verify && mismatch) ? 2 : 0;
+}
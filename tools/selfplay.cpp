@@ -0,0 +1,501 @@
+// Headless self-play runner: plays many AI-vs-AI games across a thread pool and
+// reports win/draw/loss rates. Links only the rules and the AI, never Raylib.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "GameLogic.h"
+#include "CheckersAI.h"
+#include "Evaluation.h"
+#include "GameRecord.h"
+#include "OpeningBook.h"
+#include "TrainingData.h"
+#include "Zobrist.h"
+
+namespace {
+
+/**
+ * @brief Settings for one of the two players.
+ */
+struct PlayerConfig {
+    AIDifficulty difficulty = AIDifficulty::Medium;
+    int maxDepth = 0;      ///< Overrides the difficulty's depth if > 0
+    int timeLimitMs = -1;  ///< Overrides the difficulty's time limit if >= 0
+    std::string evalPath;  ///< Evaluation weights file, empty for the built-in weights
+};
+
+/**
+ * @brief Settings for the whole run.
+ */
+struct RunConfig {
+    int games = 100;
+    int threads = 1;
+    int maxPlies = 200;      ///< Games reaching this many plies are drawn
+    std::size_t hashMb = 16; ///< Transposition table size per AI
+    std::string tablebasePath; ///< Endgame tablebase both AIs probe, empty for none
+    std::string bookPath;      ///< Opening book both AIs play from, empty for none
+    std::string bookOutPath;   ///< Build an opening book from the games, empty for none
+    int bookPlies = 16;        ///< Moves recorded per game for the new book
+    int bookMinGames = 3;      ///< Moves played in fewer games are left out of the book
+    std::string statsLogPath;  ///< Log every move's search statistics here, empty for none
+    std::string recordPath;    ///< Append every game to this game record file, empty for none
+    std::string trainPrefix;   ///< Write labelled positions to shards with this prefix, empty for none
+    bool seeded = false;       ///< Whether every game gets fresh AIs seeded from seed
+    std::uint32_t seed = 0;    ///< Game g's AIs are seeded with seed + 2g (Teal) and seed + 2g + 1
+    bool deterministic = false; ///< Search on one thread and a node budget, see CheckersAI::setDeterministic()
+    PlayerConfig teal;
+    PlayerConfig purple;
+};
+
+/**
+ * @brief Outcome of one game.
+ */
+enum class Outcome { TealWin, Draw, PurpleWin };
+
+const char *difficultyName(AIDifficulty d) {
+    switch (d) {
+        case AIDifficulty::Easy: return "easy";
+        case AIDifficulty::Medium: return "medium";
+        case AIDifficulty::Hard: return "hard";
+    }
+    return "?";
+}
+
+bool parseDifficulty(const char *text, AIDifficulty &out) {
+    if (std::strcmp(text, "easy") == 0) out = AIDifficulty::Easy;
+    else if (std::strcmp(text, "medium") == 0) out = AIDifficulty::Medium;
+    else if (std::strcmp(text, "hard") == 0) out = AIDifficulty::Hard;
+    else return false;
+    return true;
+}
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_selfplay [options]\n"
+        "  --games N              number of games to play (default 100)\n"
+        "  --threads N            games played in parallel (default 1)\n"
+        "  --max-plies N          adjudicate a draw after N plies (default 200)\n"
+        "  --hash MB              transposition table size per AI (default 16)\n"
+        "  --tablebase FILE       endgame tablebase for both AIs (default none)\n"
+        "  --book FILE            opening book for both AIs (default none)\n"
+        "  --book-out FILE        build an opening book from the games played\n"
+        "  --book-plies N         plies per game recorded in the book (default 16)\n"
+        "  --book-min-games N     leave out moves seen in fewer games (default 3)\n"
+        "  --stats-log FILE       write each move's search statistics as JSON lines\n"
+        "  --record FILE          append every game to a compact game record file\n"
+        "  --train-out PREFIX     write searched positions with their game result as\n"
+        "                         training data, one shard PREFIX-NNN.train per thread\n"
+        "  --seed N               seed each game's AIs from N so the random moves repeat\n"
+        "  --deterministic        search on one thread with a node budget instead of the\n"
+        "                         clock; with --seed every run plays the same games\n"
+        "  --teal LEVEL           easy | medium | hard (default medium)\n"
+        "  --purple LEVEL         easy | medium | hard (default medium)\n"
+        "  --teal-depth N         override Teal's search depth\n"
+        "  --purple-depth N       override Purple's search depth\n"
+        "  --teal-time MS         override Teal's per-move time limit\n"
+        "  --purple-time MS       override Purple's per-move time limit\n"
+        "  --teal-eval FILE       evaluation weights for Teal (default built-in)\n"
+        "  --purple-eval FILE     evaluation weights for Purple (default built-in)\n";
+}
+
+/**
+ * @brief Parses the command line into a run configuration.
+ * @return true on success, false if the arguments are invalid
+ */
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (arg == "--deterministic") { config.deterministic = true; continue; }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--games") config.games = std::atoi(value);
+        else if (arg == "--threads") config.threads = std::atoi(value);
+        else if (arg == "--max-plies") config.maxPlies = std::atoi(value);
+        else if (arg == "--hash") config.hashMb = static_cast<std::size_t>(std::atoi(value));
+        else if (arg == "--tablebase") config.tablebasePath = value;
+        else if (arg == "--book") config.bookPath = value;
+        else if (arg == "--book-out") config.bookOutPath = value;
+        else if (arg == "--book-plies") config.bookPlies = std::atoi(value);
+        else if (arg == "--book-min-games") config.bookMinGames = std::atoi(value);
+        else if (arg == "--stats-log") config.statsLogPath = value;
+        else if (arg == "--record") config.recordPath = value;
+        else if (arg == "--train-out") config.trainPrefix = value;
+        else if (arg == "--seed") {
+            config.seeded = true;
+            config.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if (arg == "--teal-depth") config.teal.maxDepth = std::atoi(value);
+        else if (arg == "--purple-depth") config.purple.maxDepth = std::atoi(value);
+        else if (arg == "--teal-time") config.teal.timeLimitMs = std::atoi(value);
+        else if (arg == "--purple-time") config.purple.timeLimitMs = std::atoi(value);
+        else if (arg == "--teal-eval") config.teal.evalPath = value;
+        else if (arg == "--purple-eval") config.purple.evalPath = value;
+        else if (arg == "--teal" || arg == "--purple") {
+            PlayerConfig &player = (arg == "--teal") ? config.teal : config.purple;
+            if (!parseDifficulty(value, player.difficulty)) {
+                std::cerr << "Unknown difficulty: " << value << "\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.games < 1 || config.threads < 1 || config.maxPlies < 1) {
+        std::cerr << "--games, --threads and --max-plies must be positive\n";
+        return false;
+    }
+    if (!config.tablebasePath.empty() && !EndgameTablebase().open(config.tablebasePath)) {
+        std::cerr << "Cannot open tablebase " << config.tablebasePath << "\n";
+        return false;
+    }
+    if (!config.bookPath.empty() && !OpeningBook().open(config.bookPath)) {
+        std::cerr << "Cannot open opening book " << config.bookPath << "\n";
+        return false;
+    }
+    for (const PlayerConfig *player : {&config.teal, &config.purple}) {
+        EvalWeights weights;
+        if (!player->evalPath.empty() && !loadEvalWeights(player->evalPath, weights)) {
+            std::cerr << "Cannot read evaluation weights " << player->evalPath << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Creates an AI for one side with the configured overrides applied.
+ * @param seed Seed of its random number generator, used if the run is seeded
+ */
+std::unique_ptr<CheckersAI> makePlayer(const PlayerConfig &player, const RunConfig &config, std::uint32_t seed) {
+    auto ai = config.seeded ? std::make_unique<CheckersAI>(player.difficulty, 1, seed)
+                            : std::make_unique<CheckersAI>(player.difficulty);
+    ai->setDeterministic(config.deterministic);
+    ai->setHashSizeMb(config.hashMb);
+    if (!config.tablebasePath.empty()) {
+        ai->loadTablebase(config.tablebasePath);
+    }
+    if (!config.bookPath.empty()) {
+        ai->loadOpeningBook(config.bookPath);
+    }
+    if (!player.evalPath.empty()) {
+        ai->loadEvalWeights(player.evalPath);
+    }
+    SearchLimits limits = ai->searchLimits();
+    if (player.maxDepth > 0) limits.maxDepth = player.maxDepth;
+    if (player.timeLimitMs >= 0) limits.timeLimitMs = player.timeLimitMs;
+    ai->setSearchLimits(limits);
+    return ai;
+}
+
+/**
+ * @brief Search statistics summed over the moves one side searched.
+ */
+struct SearchTotals {
+    std::uint64_t moves = 0;
+    std::uint64_t depth = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t betaCutoffs = 0;
+    std::uint64_t firstMoveCutoffs = 0;
+    double timeMs = 0;
+
+    void add(const SearchTotals &other) {
+        moves += other.moves;
+        depth += other.depth;
+        nodes += other.nodes;
+        betaCutoffs += other.betaCutoffs;
+        firstMoveCutoffs += other.firstMoveCutoffs;
+        timeMs += other.timeMs;
+    }
+};
+
+/**
+ * @brief A move played early in a game, recorded for building an opening book.
+ */
+struct BookSample {
+    std::uint64_t key;  ///< Position before the move
+    Move move;
+    bool tealMoved;     ///< Whether Teal played the move
+};
+
+/**
+ * @brief Plays one game from the starting position.
+ * A side with no legal moves loses; reaching maxPlies is a draw.
+ * @param plies Output parameter for the number of plies played
+ * @param samples If not nullptr, receives the first bookPlies moves of the game
+ * @param totals Receives the search statistics of each side (Teal, Purple)
+ * @param record Receives every move of the game (cleared first)
+ * @param training If not nullptr, receives every searched position with its score;
+ * the results are filled in by the caller once the game is over
+ */
+Outcome playGame(CheckersAI &teal, CheckersAI &purple, int maxPlies, int &plies,
+                 std::vector<BookSample> *samples, int bookPlies, SearchTotals totals[2],
+                 GameRecord &record, std::vector<TrainingPosition> *training) {
+    record.clear();
+    GameState state;
+    initBoard(state);
+    state.currentPlayer = TealMan;
+
+    for (plies = 0; plies < maxPlies; ++plies) {
+        bool tealToMove = isTealPiece(state.currentPlayer);
+        CheckersAI &ai = tealToMove ? teal : purple;
+
+        AIMove chosen = ai.chooseMove(state);
+        if (!chosen.found) {
+            return tealToMove ? Outcome::PurpleWin : Outcome::TealWin;
+        }
+        const Move &move = chosen.move;
+        if (chosen.source == MoveSource::Search) {
+            SearchTotals &side = totals[tealToMove ? 0 : 1];
+            ++side.moves;
+            side.depth += chosen.stats.depth;
+            side.nodes += chosen.stats.nodes;
+            side.betaCutoffs += chosen.stats.betaCutoffs;
+            side.firstMoveCutoffs += chosen.stats.firstMoveCutoffs;
+            side.timeMs += chosen.stats.timeMs;
+
+            if (training) {
+                TrainingPosition position;
+                position.bb = toBitboard(state);
+                position.score = static_cast<std::int16_t>(
+                    std::max<int>(std::numeric_limits<std::int16_t>::min(),
+                                  std::min<int>(std::numeric_limits<std::int16_t>::max(), chosen.score)));
+                position.side = tealToMove ? 0 : 1;
+                training->push_back(position);
+            }
+        }
+        if (samples && plies < bookPlies) {
+            samples->push_back({zobristKey(toBitboard(state), state.currentPlayer), move, tealToMove});
+        }
+        record.append(move);
+        makeMove(state, move);
+        state.currentPlayer = tealToMove ? PurpleMan : TealMan;
+    }
+    return Outcome::Draw;
+}
+
+/**
+ * @brief Gets a game's result for one side, as stored in TrainingPosition::result.
+ * @return 2 for a win, 1 for a draw, 0 for a loss
+ */
+std::uint8_t resultFor(bool teal, Outcome outcome) {
+    if (outcome == Outcome::Draw) return 1;
+    return (outcome == Outcome::TealWin) == teal ? 2 : 0;
+}
+
+/**
+ * @brief Game points a move earned for the side that played it: 2 for a win, 1 for a draw.
+ */
+int pointsFor(const BookSample &sample, Outcome outcome) {
+    if (outcome == Outcome::Draw) return 1;
+    bool tealWon = outcome == Outcome::TealWin;
+    return sample.tealMoved == tealWon ? 2 : 0;
+}
+
+/**
+ * @brief Turns recorded moves into book entries weighted by the points they earned.
+ * @param samples Recorded moves with the points each earned
+ * @param minGames Moves played in fewer games are dropped
+ * @return The entries, one per (position, move)
+ */
+std::vector<BookEntry> buildBook(const std::vector<std::pair<BookSample, int>> &samples, int minGames) {
+    struct Stats {
+        int games = 0;
+        int points = 0;
+    };
+    std::map<std::tuple<std::uint64_t, std::uint8_t, std::uint8_t, std::uint32_t>, Stats> stats;
+    for (const auto &s : samples) {
+        Stats &st = stats[{s.first.key, s.first.move.from, s.first.move.to, s.first.move.captured}];
+        ++st.games;
+        st.points += s.second;
+    }
+
+    std::vector<BookEntry> entries;
+    for (const auto &kv : stats) {
+        if (kv.second.games < minGames || kv.second.points == 0) continue;
+        BookEntry e;
+        e.key = std::get<0>(kv.first);
+        e.from = std::get<1>(kv.first);
+        e.to = std::get<2>(kv.first);
+        e.captured = std::get<3>(kv.first);
+        e.weight = static_cast<std::uint16_t>(std::min(kv.second.points, 65535));
+        entries.push_back(e);
+    }
+    return entries;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    std::atomic<int> nextGame{0};
+    std::atomic<int> tealWins{0}, draws{0}, purpleWins{0};
+    std::atomic<std::int64_t> totalPlies{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Moves recorded for the opening book, one list per worker.
+    const bool recordBook = !config.bookOutPath.empty();
+    std::vector<std::vector<std::pair<BookSample, int>>> bookSamples(config.threads);
+
+    // Every AI appends to one log; CheckersAI keeps their lines apart.
+    std::ofstream statsLog;
+    if (!config.statsLogPath.empty()) {
+        statsLog.open(config.statsLogPath);
+        if (!statsLog) {
+            std::cerr << "Cannot write " << config.statsLogPath << "\n";
+            return 1;
+        }
+    }
+    std::vector<std::array<SearchTotals, 2>> searchTotals(config.threads);
+
+    // Finished games are appended by whichever worker played them.
+    GameRecordWriter recordWriter;
+    std::mutex recordMutex;
+    if (!config.recordPath.empty() && !recordWriter.open(config.recordPath)) {
+        std::cerr << "Cannot write " << config.recordPath << "\n";
+        return 1;
+    }
+
+    // Each worker streams its positions into its own training shard, so the workers
+    // never share a file and the search stays the bottleneck.
+    const bool recordTraining = !config.trainPrefix.empty();
+    std::vector<TrainingShardWriter> trainingShards(recordTraining ? config.threads : 0);
+    for (int t = 0; t < static_cast<int>(trainingShards.size()); ++t) {
+        if (!trainingShards[t].open(trainingShardPath(config.trainPrefix, t))) {
+            std::cerr << "Cannot write " << trainingShardPath(config.trainPrefix, t) << "\n";
+            return 1;
+        }
+    }
+
+    // Each worker owns one AI per side and pulls game indices until none are left.
+    std::vector<std::thread> workers;
+    for (int t = 0; t < config.threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::unique_ptr<CheckersAI> teal, purple;
+            std::vector<BookSample> gameSamples;
+            GameRecord record;
+            std::vector<TrainingPosition> gamePositions;
+            for (int game; (game = nextGame.fetch_add(1)) < config.games;) {
+                // A seeded run gives every game fresh AIs, so a game is played the same
+                // way whichever worker picks it up.
+                if (!teal || config.seeded) {
+                    auto seed = static_cast<std::uint32_t>(config.seed + 2u * static_cast<std::uint32_t>(game));
+                    teal = makePlayer(config.teal, config, seed);
+                    purple = makePlayer(config.purple, config, seed + 1);
+                    if (statsLog.is_open()) {
+                        teal->setStatsLog(&statsLog);
+                        purple->setStatsLog(&statsLog);
+                    }
+                }
+                int plies = 0;
+                gameSamples.clear();
+                gamePositions.clear();
+                Outcome outcome = playGame(*teal, *purple, config.maxPlies, plies,
+                                           recordBook ? &gameSamples : nullptr, config.bookPlies,
+                                           searchTotals[t].data(), record,
+                                           recordTraining ? &gamePositions : nullptr);
+                for (TrainingPosition &position : gamePositions) {
+                    position.result = resultFor(position.side == 0, outcome);
+                    trainingShards[t].add(position);
+                }
+                if (recordWriter.isOpen()) {
+                    record.setOutcome(outcome == Outcome::TealWin   ? GameOutcome::TealWin
+                                      : outcome == Outcome::Draw ? GameOutcome::Draw
+                                                                 : GameOutcome::PurpleWin);
+                    std::lock_guard<std::mutex> lock(recordMutex);
+                    recordWriter.write(record);
+                }
+                for (const BookSample &sample : gameSamples) {
+                    bookSamples[t].push_back({sample, pointsFor(sample, outcome)});
+                }
+                totalPlies += plies;
+                if (outcome == Outcome::TealWin) ++tealWins;
+                else if (outcome == Outcome::PurpleWin) ++purpleWins;
+                else ++draws;
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double n = config.games;
+
+    std::printf("Games: %d (Teal %s vs Purple %s), %d threads\n", config.games,
+                difficultyName(config.teal.difficulty), difficultyName(config.purple.difficulty),
+                config.threads);
+    std::printf("Teal wins:   %6d (%5.1f%%)\n", tealWins.load(), 100.0 * tealWins / n);
+    std::printf("Draws:       %6d (%5.1f%%)\n", draws.load(), 100.0 * draws / n);
+    std::printf("Purple wins: %6d (%5.1f%%)\n", purpleWins.load(), 100.0 * purpleWins / n);
+    std::printf("Elapsed: %.2f s, %.2f games/s, %.1f plies/game\n", seconds,
+                seconds > 0 ? n / seconds : 0.0, totalPlies / n);
+
+    const char *const sideNames[2] = {"Teal", "Purple"};
+    for (int side = 0; side < 2; ++side) {
+        SearchTotals sum;
+        for (const auto &perWorker : searchTotals) {
+            sum.add(perWorker[side]);
+        }
+        if (sum.moves == 0) continue;
+        std::printf("%-6s search: %llu moves, depth %.1f, %.1f ms/move, %.2f Mnps, first-move cutoffs %.1f%%\n",
+                    sideNames[side], static_cast<unsigned long long>(sum.moves),
+                    static_cast<double>(sum.depth) / sum.moves, sum.timeMs / sum.moves,
+                    sum.timeMs > 0 ? sum.nodes / sum.timeMs / 1000.0 : 0.0,
+                    sum.betaCutoffs ? 100.0 * sum.firstMoveCutoffs / sum.betaCutoffs : 0.0);
+    }
+
+    if (recordTraining) {
+        std::uint64_t positions = 0;
+        for (TrainingShardWriter &shard : trainingShards) {
+            positions += shard.size();
+            if (!shard.close()) {
+                std::cerr << "Cannot finish writing the training shards " << config.trainPrefix << "-*\n";
+                return 1;
+            }
+        }
+        std::printf("Training data: %llu positions in %zu shards %s-*.train\n",
+                    static_cast<unsigned long long>(positions), trainingShards.size(), config.trainPrefix.c_str());
+    }
+
+    if (recordBook) {
+        std::vector<std::pair<BookSample, int>> all;
+        for (const auto &perWorker : bookSamples) {
+            all.insert(all.end(), perWorker.begin(), perWorker.end());
+        }
+        std::vector<BookEntry> entries = buildBook(all, config.bookMinGames);
+        if (!writeOpeningBook(config.bookOutPath, entries)) {
+            std::cerr << "Cannot write " << config.bookOutPath << "\n";
+            return 1;
+        }
+        std::printf("Opening book: %zu moves written to %s\n", entries.size(), config.bookOutPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,661 @@
+// Game server: hosts many independent games against the AI in one process, for
+// clients connecting over TCP. Each game is a packed position plus its compact
+// move record; AI replies are searched on a shared pool of worker threads, each
+// game with its own time budget.
+//
+// The protocol is line-based text, one command per line, with moves in PDN
+// notation (see Notation.h). The client plays Teal and always moves first:
+//   NEW [easy|medium|hard] [MS]   start a game          -> GAME id
+//   MOVE id MOVE                  play a move            -> MOVE id REPLY, later
+//   MOVES id                      list the legal moves   -> MOVES id m1 m2 ...
+//   BOARD id                      show the position      -> BOARD id FEN
+//   CLOSE id                      abandon a game         -> CLOSED id
+//   STATS                         server load            -> STATS ...
+//   QUIT                          close the connection
+// A finished game is announced with "END id teal|purple|draw" and forgotten.
+// Errors are reported as "ERR [id] reason". Replies for different games may
+// arrive in any order, as AI moves are sent as soon as their search finishes.
+
+#if defined(_WIN32)
+
+#include <iostream>
+
+int main() {
+    std::cerr << "checkers_server needs POSIX sockets and is not available on Windows\n";
+    return 1;
+}
+
+#else
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Bitboard.h"
+#include "CheckersAI.h"
+#include "GameRecord.h"
+#include "Notation.h"
+
+namespace {
+
+struct RunConfig {
+    int port = 7070;
+    int workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::size_t hashMb = 8;    ///< Transposition table of each worker's AI, per difficulty
+    int defaultTimeMs = 1000;  ///< Search budget of games that do not set one
+    int maxPlies = 200;        ///< Games longer than this are drawn
+    std::size_t maxGames = 100000;
+    std::string recordPath;    ///< Append finished games here, empty for none
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_server [options]\n"
+        "  --port N           TCP port to listen on (default 7070)\n"
+        "  --workers N        threads searching AI moves (default: all cores)\n"
+        "  --hash MB          transposition table per worker and difficulty (default 8)\n"
+        "  --time MS          search budget of games that set none (default 1000)\n"
+        "  --max-plies N      draw games after N plies (default 200)\n"
+        "  --max-games N      refuse new games beyond N running ones (default 100000)\n"
+        "  --record FILE      append every finished game to FILE\n";
+}
+
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--port") config.port = std::atoi(value);
+        else if (arg == "--workers") config.workers = std::atoi(value);
+        else if (arg == "--hash") config.hashMb = std::strtoul(value, nullptr, 10);
+        else if (arg == "--time") config.defaultTimeMs = std::atoi(value);
+        else if (arg == "--max-plies") config.maxPlies = std::atoi(value);
+        else if (arg == "--max-games") config.maxGames = std::strtoul(value, nullptr, 10);
+        else if (arg == "--record") config.recordPath = value;
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.port < 1 || config.port > 65535 || config.workers < 1 || config.hashMb < 1 ||
+        config.defaultTimeMs < 1 || config.defaultTimeMs > 60000 || config.maxPlies < 1) {
+        std::cerr << "--port must be in [1, 65535], --time in [1, 60000] and the other values positive\n";
+        return false;
+    }
+    return true;
+}
+
+constexpr int MAX_TIME_MS = 60000;
+constexpr std::size_t MAX_LINE = 1024;
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+/**
+ * @brief One game. Kept small, as a server may hold hundreds of thousands.
+ */
+struct Game {
+    Bitboard bb;                 ///< Current position
+    GameRecord record;           ///< Moves so far, one or two bytes each
+    int connection = -1;         ///< Socket of the client playing the game
+    std::uint16_t timeMs = 0;    ///< AI search budget per move
+    AIDifficulty level = AIDifficulty::Medium;
+    bool aiToMove = false;       ///< Whether a worker is searching the AI's reply
+};
+
+/**
+ * @brief A search for a worker: the AI's reply in one game.
+ */
+struct Job {
+    std::uint32_t gameId;
+    Bitboard bb;  ///< Position with Purple to move
+    AIDifficulty level;
+    int timeMs;
+};
+
+/**
+ * @brief A finished search, handed back to the network thread.
+ */
+struct Reply {
+    std::uint32_t gameId;
+    bool found;  ///< false if the AI had no legal move
+    Move move;
+};
+
+/**
+ * @brief Threads that search AI replies for every game. Each thread keeps one AI per
+ * difficulty, created the first time a game of that difficulty needs it, and reuses
+ * its transposition table across games.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Starts the worker threads.
+     * @param count Number of threads
+     * @param hashMb Transposition table size of each AI
+     * @param wakeFd Written to after every finished search, to wake the network thread
+     */
+    void start(int count, std::size_t hashMb, int wakeFd) {
+        this->hashMb = hashMb;
+        this->wakeFd = wakeFd;
+        for (int i = 0; i < count; ++i) {
+            threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    /**
+     * @brief Stops the threads once their current searches finish; queued jobs are dropped.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto &t : threads) {
+            t.join();
+        }
+        threads.clear();
+    }
+
+    /**
+     * @brief Queues a search.
+     * @param job The game and position to search
+     */
+    void submit(const Job &job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(job);
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * @brief Moves every finished search into replies.
+     * @param replies Output vector, appended to
+     */
+    void takeReplies(std::vector<Reply> &replies) {
+        std::lock_guard<std::mutex> lock(mutex);
+        replies.insert(replies.end(), done.begin(), done.end());
+        done.clear();
+    }
+
+    /**
+     * @brief Gets the number of searches waiting for a worker.
+     * @return Queue length
+     */
+    std::size_t queued() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return jobs.size();
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Job> jobs;
+    std::vector<Reply> done;
+    bool stopping = false;
+    std::size_t hashMb = 8;
+    int wakeFd = -1;
+
+    void run() {
+        std::array<std::unique_ptr<CheckersAI>, 3> ais;
+        std::array<SearchLimits, 3> levelLimits;  ///< Each difficulty's own budget
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = jobs.front();
+                jobs.pop_front();
+            }
+
+            int level = static_cast<int>(job.level);
+            std::unique_ptr<CheckersAI> &ai = ais[level];
+            if (!ai) {
+                ai = std::make_unique<CheckersAI>(job.level);
+                ai->setHashSizeMb(hashMb);
+                ai->loadTablebase("assets/endgame.tb");
+                ai->loadOpeningBook("assets/opening.book");
+                ai->loadEvalWeights("assets/eval.cfg");
+                levelLimits[level] = ai->searchLimits();
+            }
+            // The difficulty's depth limit stays; the game's budget caps the time.
+            SearchLimits limits = levelLimits[level];
+            limits.timeLimitMs = job.timeMs;
+            ai->setSearchLimits(limits);
+
+            GameState state;
+            fromBitboard(job.bb, state);
+            state.currentPlayer = PurpleMan;
+            Reply reply{job.gameId, false, Move()};
+            reply.found = ai->chooseMove(state, reply.move);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.push_back(reply);
+            }
+            char byte = 1;
+            // A full pipe already holds a pending wake-up, so a failed write loses nothing.
+            if (write(wakeFd, &byte, 1) < 0) {}
+        }
+    }
+};
+
+/**
+ * @brief A client connection: buffered input and output and the games it plays.
+ */
+struct Connection {
+    std::string in;             ///< Bytes received after the last complete line
+    std::string out;            ///< Bytes waiting to be sent
+    std::vector<std::uint32_t> games;
+    bool closing = false;       ///< Close once out is sent
+};
+
+/**
+ * @brief The network thread's state: every connection and game.
+ */
+class Server {
+public:
+    Server(const RunConfig &config, WorkerPool &pool, GameRecordWriter *writer)
+        : config(config), pool(pool), writer(writer) {}
+
+    /**
+     * @brief Registers a new client.
+     * @param fd Its socket
+     */
+    void addConnection(int fd) { connections[fd]; }
+
+    /**
+     * @brief Forgets a client and abandons its games.
+     * @param fd Its socket, closed by the caller
+     */
+    void removeConnection(int fd) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) return;
+        for (std::uint32_t id : it->second.games) {
+            auto game = games.find(id);
+            if (game != games.end()) {
+                record(game->second, GameOutcome::Unfinished);
+                games.erase(game);
+            }
+        }
+        connections.erase(it);
+    }
+
+    /**
+     * @brief Handles bytes received from a client, running every complete line.
+     * @param fd The client's socket
+     * @param data The bytes
+     * @param size Number of bytes
+     */
+    void receive(int fd, const char *data, std::size_t size) {
+        Connection &conn = connections[fd];
+        conn.in.append(data, size);
+        std::size_t start = 0, end;
+        while (!conn.closing && (end = conn.in.find('\n', start)) != std::string::npos) {
+            std::string line = conn.in.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            start = end + 1;
+            handleLine(fd, line);
+        }
+        conn.in.erase(0, start);
+        if (conn.in.size() > MAX_LINE) {
+            send(fd, "ERR line too long");
+            conn.closing = true;
+        }
+    }
+
+    /**
+     * @brief Plays the AI moves of every finished search and sends them to their clients.
+     * @param replies The finished searches
+     */
+    void applyReplies(const std::vector<Reply> &replies) {
+        for (const Reply &reply : replies) {
+            auto it = games.find(reply.gameId);
+            if (it == games.end()) continue;  // closed while the AI was thinking
+            Game &game = it->second;
+            game.aiToMove = false;
+            --thinking;
+            if (!reply.found) {
+                finish(reply.gameId, GameOutcome::TealWin);
+                continue;
+            }
+            game.record.append(reply.move);
+            makeMove(game.bb, reply.move);
+            send(game.connection, "MOVE " + std::to_string(reply.gameId) + " " + moveToString(reply.move));
+            checkFinished(reply.gameId, TealMan);
+        }
+    }
+
+    /**
+     * @brief Gets the connections by socket, for polling.
+     * @return Every connection
+     */
+    std::unordered_map<int, Connection> &clients() { return connections; }
+
+    /**
+     * @brief Gets the number of games served since startup.
+     * @return Games started
+     */
+    std::uint64_t gamesStarted() const { return nextId - 1; }
+
+private:
+    const RunConfig &config;
+    WorkerPool &pool;
+    GameRecordWriter *writer;  ///< Finished games are appended here, may be nullptr
+    std::unordered_map<int, Connection> connections;
+    std::unordered_map<std::uint32_t, Game> games;
+    std::uint32_t nextId = 1;
+    std::size_t thinking = 0;  ///< Games whose AI reply is being searched or queued
+
+    void send(int fd, const std::string &line) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) return;
+        it->second.out += line;
+        it->second.out += '\n';
+    }
+
+    /**
+     * @brief Finds a game of the client, reporting an error if it has none with that id.
+     */
+    Game *findGame(int fd, const std::string &idText, std::uint32_t &id) {
+        id = static_cast<std::uint32_t>(std::strtoul(idText.c_str(), nullptr, 10));
+        auto it = games.find(id);
+        if (it == games.end() || it->second.connection != fd) {
+            send(fd, "ERR " + idText + " unknown game");
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    void record(const Game &game, GameOutcome outcome) {
+        if (game.aiToMove) --thinking;
+        if (!writer || game.record.plyCount() == 0) return;
+        GameRecord finished = game.record;
+        finished.setOutcome(outcome);
+        writer->write(finished);
+    }
+
+    void finish(std::uint32_t id, GameOutcome outcome) {
+        auto it = games.find(id);
+        Game &game = it->second;
+        const char *result = outcome == GameOutcome::TealWin ? "teal"
+                           : outcome == GameOutcome::PurpleWin ? "purple" : "draw";
+        send(game.connection, "END " + std::to_string(id) + " " + result);
+        record(game, outcome);
+        auto &owned = connections[game.connection].games;
+        owned.erase(std::remove(owned.begin(), owned.end(), id), owned.end());
+        games.erase(it);
+    }
+
+    /**
+     * @brief Ends the game if the side to move has lost or the ply limit is reached.
+     * @return true if the game ended
+     */
+    bool checkFinished(std::uint32_t id, Piece toMove) {
+        Game &game = games.find(id)->second;
+        if (!hasAnyMoves(game.bb, toMove)) {
+            finish(id, isTealPiece(toMove) ? GameOutcome::PurpleWin : GameOutcome::TealWin);
+            return true;
+        }
+        if (game.record.plyCount() >= config.maxPlies) {
+            finish(id, GameOutcome::Draw);
+            return true;
+        }
+        return false;
+    }
+
+    void handleLine(int fd, const std::string &line) {
+        std::istringstream words(line);
+        std::string command, idText, arg;
+        words >> command >> idText >> arg;
+        if (command.empty()) return;
+
+        if (command == "NEW") {
+            newGame(fd, idText, arg);
+        } else if (command == "MOVE") {
+            std::uint32_t id;
+            Game *game = findGame(fd, idText, id);
+            if (game) playMove(fd, id, *game, arg);
+        } else if (command == "MOVES") {
+            std::uint32_t id;
+            Game *game = findGame(fd, idText, id);
+            if (!game) return;
+            MoveList moves;
+            if (!game->aiToMove) generateMoves(game->bb, TealMan, moves);
+            std::string text = "MOVES " + idText;
+            for (const Move &m : moves) text += " " + moveToString(m);
+            send(fd, text);
+        } else if (command == "BOARD") {
+            std::uint32_t id;
+            Game *game = findGame(fd, idText, id);
+            if (game) send(fd, "BOARD " + idText + " " + toFen(game->bb, game->aiToMove ? PurpleMan : TealMan));
+        } else if (command == "CLOSE") {
+            std::uint32_t id;
+            Game *game = findGame(fd, idText, id);
+            if (!game) return;
+            record(*game, GameOutcome::Unfinished);
+            auto &owned = connections[fd].games;
+            owned.erase(std::remove(owned.begin(), owned.end(), id), owned.end());
+            games.erase(id);
+            send(fd, "CLOSED " + idText);
+        } else if (command == "STATS") {
+            send(fd, "STATS games " + std::to_string(games.size()) + " connections " +
+                     std::to_string(connections.size()) + " thinking " + std::to_string(thinking) +
+                     " queued " + std::to_string(pool.queued()));
+        } else if (command == "QUIT") {
+            connections[fd].closing = true;
+        } else {
+            send(fd, "ERR unknown command " + command);
+        }
+    }
+
+    void newGame(int fd, const std::string &levelText, const std::string &timeText) {
+        if (games.size() >= config.maxGames) {
+            send(fd, "ERR server full");
+            return;
+        }
+        Game game;
+        if (levelText.empty() || levelText == "medium") game.level = AIDifficulty::Medium;
+        else if (levelText == "easy") game.level = AIDifficulty::Easy;
+        else if (levelText == "hard") game.level = AIDifficulty::Hard;
+        else {
+            send(fd, "ERR unknown difficulty " + levelText);
+            return;
+        }
+        int timeMs = timeText.empty() ? config.defaultTimeMs : std::atoi(timeText.c_str());
+        if (timeMs < 1 || timeMs > MAX_TIME_MS) {
+            send(fd, "ERR time must be in [1, " + std::to_string(MAX_TIME_MS) + "] ms");
+            return;
+        }
+        game.timeMs = static_cast<std::uint16_t>(timeMs);
+        game.connection = fd;
+        GameState start;
+        initBoard(start);
+        game.bb = toBitboard(start);
+
+        std::uint32_t id = nextId++;
+        games.emplace(id, std::move(game));
+        connections[fd].games.push_back(id);
+        send(fd, "GAME " + std::to_string(id));
+    }
+
+    void playMove(int fd, std::uint32_t id, Game &game, const std::string &text) {
+        if (game.aiToMove) {
+            send(fd, "ERR " + std::to_string(id) + " not your turn");
+            return;
+        }
+        MoveList legal;
+        generateMoves(game.bb, TealMan, legal);
+        Move move;
+        if (!parseMove(text, legal, move)) {
+            send(fd, "ERR " + std::to_string(id) + " illegal move " + text);
+            return;
+        }
+        game.record.append(move);
+        makeMove(game.bb, move);
+        if (checkFinished(id, PurpleMan)) return;
+
+        game.aiToMove = true;
+        ++thinking;
+        pool.submit({id, game.bb, game.level, game.timeMs});
+    }
+};
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+/**
+ * @brief Opens the listening socket.
+ * @return The socket, -1 on failure
+ */
+int listenOn(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+    setNonBlocking(fd);
+    return fd;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    GameRecordWriter writer;
+    if (!config.recordPath.empty() && !writer.open(config.recordPath)) {
+        std::cerr << "Cannot write " << config.recordPath << "\n";
+        return 1;
+    }
+    int listener = listenOn(config.port);
+    if (listener < 0) {
+        std::cerr << "Cannot listen on port " << config.port << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    // Workers wake the network thread through this pipe when a search finishes.
+    int wake[2];
+    if (pipe(wake) < 0) {
+        std::cerr << "Cannot create pipe: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    setNonBlocking(wake[0]);
+    setNonBlocking(wake[1]);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    WorkerPool pool;
+    pool.start(config.workers, config.hashMb, wake[1]);
+    Server server(config, pool, writer.isOpen() ? &writer : nullptr);
+    std::printf("Listening on port %d with %d workers\n", config.port, config.workers);
+    std::fflush(stdout);
+
+    std::vector<pollfd> fds;
+    std::vector<Reply> replies;
+    char buffer[4096];
+    while (!stopRequested) {
+        fds.clear();
+        fds.push_back({listener, POLLIN, 0});
+        fds.push_back({wake[0], POLLIN, 0});
+        for (auto &kv : server.clients()) {
+            short events = POLLIN;
+            if (!kv.second.out.empty()) events |= POLLOUT;
+            fds.push_back({kv.first, events, 0});
+        }
+        if (poll(fds.data(), fds.size(), 250) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "poll failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            while (read(wake[0], buffer, sizeof(buffer)) > 0) {}
+            replies.clear();
+            pool.takeReplies(replies);
+            server.applyReplies(replies);
+        }
+
+        for (std::size_t i = 2; i < fds.size(); ++i) {
+            int fd = fds[i].fd;
+            bool drop = fds[i].revents & (POLLERR | POLLNVAL);
+            if (!drop && (fds[i].revents & (POLLIN | POLLHUP))) {
+                ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                if (n > 0) server.receive(fd, buffer, static_cast<std::size_t>(n));
+                else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) drop = true;
+            }
+            Connection &conn = server.clients()[fd];
+            if (!drop && !conn.out.empty()) {
+                ssize_t n = ::send(fd, conn.out.data(), conn.out.size(), 0);
+                if (n > 0) conn.out.erase(0, static_cast<std::size_t>(n));
+                else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) drop = true;
+            }
+            if (drop || (conn.closing && conn.out.empty())) {
+                server.removeConnection(fd);
+                close(fd);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listener, nullptr, nullptr)) >= 0) {
+                setNonBlocking(fd);
+                int yes = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                server.addConnection(fd);
+            }
+        }
+    }
+
+    pool.stop();
+    std::printf("Served %llu games\n", static_cast<unsigned long long>(server.gamesStarted()));
+    return 0;
+}
+
+#endif
@@ -0,0 +1,356 @@
+// Tablebase generator: solves every position with up to N pieces by retrograde
+// analysis and writes the results in the format read by EndgameTablebase.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Bitboard.h"
+#include "EndgameTablebase.h"
+#include "Notation.h"
+#include "SearchEngine.h"
+
+namespace {
+
+struct RunConfig {
+    int pieces = 4;
+    std::string outPath = "assets/endgame.tb";
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_tbgen [options]\n"
+        "  --pieces N     solve every position with up to N pieces (default 4, max "
+     << TB_MAX_PIECES << ")\n"
+        "  --out FILE     output file (default assets/endgame.tb)\n";
+}
+
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--pieces") config.pieces = std::atoi(value);
+        else if (arg == "--out") config.outPath = value;
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.pieces < 2 || config.pieces > TB_MAX_PIECES) {
+        std::cerr << "--pieces must be between 2 and " << TB_MAX_PIECES << "\n";
+        return false;
+    }
+    return true;
+}
+
+Piece opponentOf(Piece side) {
+    return isTealPiece(side) ? PurpleMan : TealMan;
+}
+
+/**
+ * @brief Lists every material with 2..maxPieces pieces and at least one piece per side,
+ * in an order where each table only depends on tables before it: captures lower the
+ * piece count and crowning lowers the number of men.
+ */
+std::vector<MaterialSignature> signaturesToSolve(int maxPieces) {
+    std::vector<MaterialSignature> sigs;
+    for (int tm = 0; tm <= maxPieces; ++tm)
+        for (int tk = 0; tm + tk <= maxPieces; ++tk)
+            for (int pm = 0; tm + tk + pm <= maxPieces; ++pm)
+                for (int pk = 0; tm + tk + pm + pk <= maxPieces; ++pk) {
+                    if (tm + tk == 0 || pm + pk == 0) continue;
+                    sigs.push_back({tm, tk, pm, pk});
+                }
+
+    std::stable_sort(sigs.begin(), sigs.end(), [](const MaterialSignature &a, const MaterialSignature &b) {
+        if (a.total() != b.total()) return a.total() < b.total();
+        return a.tealMen + a.purpleMen < b.tealMen + b.purpleMen;
+    });
+    return sigs;
+}
+
+std::string describe(const MaterialSignature &sig) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "Teal %dm%dk v Purple %dm%dk", sig.tealMen, sig.tealKings,
+                  sig.purpleMen, sig.purpleKings);
+    return text;
+}
+
+/**
+ * @brief Solves tables one material at a time and keeps the finished ones for lookups.
+ */
+class Solver {
+public:
+    /**
+     * @brief Solves one material. Every table it can reach by a capture or a crowning
+     * must already be solved.
+     * @param sig The material to solve
+     */
+    void solve(const MaterialSignature &sig) {
+        auto start = std::chrono::steady_clock::now();
+        const std::uint64_t size = tablebaseSize(sig);
+        std::vector<std::uint8_t> &values = tables[sig.code()];
+        values.assign(size, 0);
+
+        // Generate the moves of every position once. Moves into finished tables are
+        // folded into a summary; moves within this table are kept as child indices.
+        std::vector<Pending> pending;
+        std::vector<std::uint32_t> children;
+        std::uint64_t positions = 0;
+        for (std::uint64_t index = 0; index < size; ++index) {
+            Bitboard bb;
+            Piece side;
+            if (!tablebasePosition(sig, index, bb, side)) continue;
+            ++positions;
+
+            MoveList moves;
+            generateMoves(bb, side, moves);
+            if (moves.empty()) {
+                values[index] = encodeTablebaseValue(0);
+                continue;
+            }
+
+            Pending p;
+            p.index = static_cast<std::uint32_t>(index);
+            p.firstChild = static_cast<std::uint32_t>(children.size());
+            for (const Move &move : moves) {
+                UndoRecord undo = makeMove(bb, move);
+                Piece other = opponentOf(side);
+                std::uint32_t own = isTealPiece(other) ? bb.teal : bb.purple;
+                MaterialSignature childSig = materialOf(bb);
+                if (own == 0) {
+                    p.minExternalLoss = 0;
+                } else if (childSig.code() == sig.code()) {
+                    children.push_back(static_cast<std::uint32_t>(tablebaseIndex(bb, other, childSig)));
+                } else {
+                    TBResult child = decodeTablebaseValue(
+                        tables[childSig.code()][tablebaseIndex(bb, other, childSig)]);
+                    if (child.outcome == TBOutcome::Loss) {
+                        p.minExternalLoss = std::min(p.minExternalLoss, child.distance);
+                    } else if (child.outcome == TBOutcome::Win) {
+                        p.maxExternalWin = std::max(p.maxExternalWin, child.distance);
+                    } else {
+                        p.externalDraw = true;
+                    }
+                }
+                unmakeMove(bb, move, undo);
+            }
+            p.childCount = static_cast<std::uint32_t>(children.size()) - p.firstChild;
+            pending.push_back(p);
+        }
+
+        // Pass k finds the wins in k plies (odd k) or the losses in k plies (even k).
+        // A result found in pass k has distance exactly k, so it never affects other
+        // decisions of the same pass, which only accept distances below k.
+        int quietPasses = 0;
+        int longest = 0;
+        for (int k = 1; k <= TB_MAX_DISTANCE && !pending.empty(); ++k) {
+            std::size_t kept = 0;
+            bool changed = false;
+            for (const Pending &p : pending) {
+                if (resolves(p, values, children, k)) {
+                    values[p.index] = encodeTablebaseValue(k);
+                    changed = true;
+                    longest = k;
+                    if (k % 2 == 1 && k > longestWin.distance) {
+                        longestWin = {sig, p.index, k};
+                    }
+                } else {
+                    pending[kept++] = p;
+                }
+            }
+            pending.resize(kept);
+
+            // Nothing new can appear once two passes in a row found nothing and no
+            // reachable table still holds a longer result.
+            quietPasses = changed ? 0 : quietPasses + 1;
+            if (quietPasses >= 2 && k > longestSolved + 1) break;
+        }
+        longestSolved = std::max(longestSolved, longest);
+
+        std::uint64_t wins = 0, losses = 0;
+        for (std::uint64_t index = 0; index < size; ++index) {
+            TBResult r = decodeTablebaseValue(values[index]);
+            if (r.outcome == TBOutcome::Win) ++wins;
+            if (r.outcome == TBOutcome::Loss) ++losses;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-28s %10llu positions  %9llu wins  %9llu losses  %9llu draws  longest %3d  %6.2f s\n",
+                    describe(sig).c_str(), static_cast<unsigned long long>(positions),
+                    static_cast<unsigned long long>(wins), static_cast<unsigned long long>(losses),
+                    static_cast<unsigned long long>(positions - wins - losses), longest, seconds);
+    }
+
+    /**
+     * @brief Gets a solved table.
+     * @param sig The material
+     * @return The table's entries
+     */
+    const std::vector<std::uint8_t> &table(const MaterialSignature &sig) const {
+        return tables[sig.code()];
+    }
+
+    /**
+     * @brief A won position of a solved table.
+     */
+    struct Win {
+        MaterialSignature sig;
+        std::uint64_t index = 0;  ///< Index in the table
+        int distance = 0;         ///< Plies to the win, 0 if no table has a win
+    };
+
+    /**
+     * @brief Gets the won position furthest from the end of the game in any solved table.
+     * @return The position, with distance 0 if there is none
+     */
+    const Win &longestWinFound() const { return longestWin; }
+
+private:
+    static constexpr int NO_DISTANCE = TB_MAX_DISTANCE + 1;
+
+    /**
+     * @brief A position of the table being solved whose result is not known yet.
+     */
+    struct Pending {
+        std::uint32_t index = 0;       ///< Index in the table
+        std::uint32_t firstChild = 0;  ///< First of its moves that stay in the table
+        std::uint32_t childCount = 0;  ///< Number of moves that stay in the table
+        int minExternalLoss = NO_DISTANCE; ///< Shortest opponent loss reached through other tables
+        int maxExternalWin = 0;        ///< Longest opponent win reached through other tables
+        bool externalDraw = false;     ///< Whether some move leads to a drawn finished table
+    };
+
+    std::vector<std::vector<std::uint8_t>> tables =
+        std::vector<std::vector<std::uint8_t>>(TB_SIGNATURE_CODES);
+    int longestSolved = 0; ///< Longest distance in any finished table
+    Win longestWin;        ///< Longest win in any finished table
+
+    /**
+     * @brief Checks if a pending position is decided with distance k.
+     * Odd k: some move reaches a loss for the opponent within k - 1 plies.
+     * Even k: every move reaches a win for the opponent within k - 1 plies.
+     */
+    static bool resolves(const Pending &p, const std::vector<std::uint8_t> &values,
+                         const std::vector<std::uint32_t> &children, int k) {
+        // A zero byte in the table being solved may still be unknown; either way it
+        // is not yet a decided result within k - 1 plies.
+        const std::uint8_t limit = encodeTablebaseValue(k - 1);
+        if (k % 2 == 1) {
+            if (p.minExternalLoss <= k - 1) return true;
+            for (std::uint32_t i = 0; i < p.childCount; ++i) {
+                std::uint8_t v = values[children[p.firstChild + i]];
+                if (v != 0 && v <= limit && decodeTablebaseValue(v).outcome == TBOutcome::Loss) return true;
+            }
+            return false;
+        }
+
+        if (p.externalDraw || p.minExternalLoss != NO_DISTANCE || p.maxExternalWin > k - 1) return false;
+        for (std::uint32_t i = 0; i < p.childCount; ++i) {
+            std::uint8_t v = values[children[p.firstChild + i]];
+            if (v == 0 || v > limit || decodeTablebaseValue(v).outcome != TBOutcome::Win) return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Checks that the search treats a tablebase win as solved, however long it is:
+ * searching the win with the written tablebase must stop after depth 1 with a score
+ * in the forced-win band.
+ * @param path The tablebase just written
+ * @param win The won position to search
+ * @return true if the check passed
+ */
+bool checkSearch(const std::string &path, const Solver::Win &win) {
+    EndgameTablebase tablebase;
+    if (!tablebase.open(path)) {
+        std::cerr << "Cannot reopen " << path << "\n";
+        return false;
+    }
+    Bitboard bb;
+    Piece side;
+    tablebasePosition(win.sig, win.index, bb, side);
+
+    SearchEngine engine;
+    engine.setTablebase(&tablebase);
+    SearchLimits limits;
+    limits.maxDepth = 20;
+    SearchResult result = engine.search(bb, side, limits);
+    bool ok = result.stats.depth == 1 && result.score >= MATE_BOUND;
+    std::printf("Search check: %s (win in %d) stopped at depth %d with score %d  %s\n",
+                toFen(bb, side).c_str(), win.distance, result.stats.depth, result.score, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MaterialSignature> sigs = signaturesToSolve(config.pieces);
+    Solver solver;
+    for (const MaterialSignature &sig : sigs) {
+        solver.solve(sig);
+    }
+
+    std::ofstream out(config.outPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Cannot write " << config.outPath << "\n";
+        return 1;
+    }
+
+    TablebaseFileHeader header{};
+    std::memcpy(header.magic, TB_MAGIC, sizeof(TB_MAGIC));
+    header.rulesVersion = RULES_VERSION;
+    header.maxPieces = static_cast<std::uint32_t>(config.pieces);
+    header.tableCount = static_cast<std::uint32_t>(sigs.size());
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::uint64_t offset = sizeof(header) + sigs.size() * sizeof(TablebaseTableInfo);
+    for (const MaterialSignature &sig : sigs) {
+        TablebaseTableInfo info{};
+        info.tealMen = static_cast<std::uint8_t>(sig.tealMen);
+        info.tealKings = static_cast<std::uint8_t>(sig.tealKings);
+        info.purpleMen = static_cast<std::uint8_t>(sig.purpleMen);
+        info.purpleKings = static_cast<std::uint8_t>(sig.purpleKings);
+        info.offset = offset;
+        info.size = solver.table(sig).size();
+        out.write(reinterpret_cast<const char *>(&info), sizeof(info));
+        offset += info.size;
+    }
+    for (const MaterialSignature &sig : sigs) {
+        const std::vector<std::uint8_t> &table = solver.table(sig);
+        out.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(table.size()));
+    }
+    if (!out) {
+        std::cerr << "Failed writing " << config.outPath << "\n";
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Wrote %zu tables (%.1f MB) to %s in %.1f s\n", sigs.size(), offset / (1024.0 * 1024.0),
+                config.outPath.c_str(), seconds);
+
+    if (solver.longestWinFound().distance > 0 && !checkSearch(config.outPath, solver.longestWinFound())) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+// Evaluation tuner: fits the evaluation weights to self-play training data with
+// Texel-style logistic tuning. Each position's score is mapped to an expected
+// result with a sigmoid and the weights are adjusted one at a time while that
+// lowers the mean squared error against the game results.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BatchEvaluator.h"
+#include "Evaluation.h"
+#include "TrainingData.h"
+
+namespace {
+
+struct RunConfig {
+    std::vector<std::string> shards;
+    std::string evalPath;      ///< Weights to start from, empty for the built-in weights
+    std::string outPath = "eval_tuned.cfg";
+    int threads = 1;
+    int passes = 20;           ///< Upper bound on passes over all weights
+    double lambda = 1.0;       ///< Weight of the game result against the search score in the target
+    bool quietOnly = true;     ///< Skip positions with a capture to make, which the evaluation never sees
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: checkers_tune SHARD... [options]\n"
+        "  --eval FILE        weights to start from (default built-in)\n"
+        "  --out FILE         where to write the tuned weights (default eval_tuned.cfg)\n"
+        "  --threads N        threads computing the error (default 1)\n"
+        "  --passes N         stop after N passes over the weights (default 20)\n"
+        "  --lambda X         target = X * result + (1 - X) * search score (default 1)\n"
+        "  --all-positions    also use positions where a capture is pending\n";
+}
+
+bool parseArgs(int argc, char *argv[], RunConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (arg == "--all-positions") { config.quietOnly = false; continue; }
+        if (arg.rfind("--", 0) != 0) {
+            config.shards.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const char *value = argv[++i];
+
+        if (arg == "--eval") config.evalPath = value;
+        else if (arg == "--out") config.outPath = value;
+        else if (arg == "--threads") config.threads = std::atoi(value);
+        else if (arg == "--passes") config.passes = std::atoi(value);
+        else if (arg == "--lambda") config.lambda = std::atof(value);
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.shards.empty()) {
+        std::cerr << "No training shards given\n";
+        return false;
+    }
+    if (config.threads < 1 || config.passes < 0 || config.lambda < 0 || config.lambda > 1) {
+        std::cerr << "--threads must be positive, --passes non-negative and --lambda in [0, 1]\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps a score in hundredths of a man to an expected result in [0, 1].
+ * @param k Steepness, fitted to the data before tuning
+ */
+double expectedResult(double score, double k) {
+    return 1.0 / (1.0 + std::exp(-k * score / 100.0));
+}
+
+/**
+ * @brief The tuning set: positions with the side to move and the result to fit.
+ */
+struct DataSet {
+    std::vector<Bitboard> positions;
+    std::vector<Piece> sides;
+    std::vector<float> results;  ///< Result for the side to move: 0, 0.5 or 1
+    std::vector<float> searchScores;
+};
+
+/**
+ * @brief Checks whether the side to move has a capture, which makes the position
+ * one the search resolves before it evaluates.
+ */
+bool hasCapture(const Bitboard &bb, Piece side) {
+    MoveList moves;
+    generateMoves(bb, side, moves);
+    return !moves.empty() && moves[0].isCapture();
+}
+
+/**
+ * @brief Evaluates every position with the given weights, split across threads.
+ * @param scores Output array, one score per position
+ */
+void evaluateAll(const DataSet &data, const EvalWeights &weights, int threads, std::vector<int> &scores) {
+    const BatchEvaluator evaluator(weights);
+    const std::size_t count = data.positions.size();
+    scores.resize(count);
+    const std::size_t perThread = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        std::size_t begin = std::min(count, t * perThread);
+        std::size_t end = std::min(count, begin + perThread);
+        workers.emplace_back([&, begin, end]() {
+            evaluator.evaluate(data.positions.data() + begin, data.sides.data() + begin,
+                               static_cast<int>(end - begin), scores.data() + begin);
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+/**
+ * @brief Mean squared error of the weights over the whole set, split across threads.
+ * Each thread evaluates its slice in batches and sums its own errors.
+ */
+double tuningError(const DataSet &data, const EvalWeights &weights, const std::vector<float> &targets,
+                   double k, int threads) {
+    constexpr int BATCH = 4096;
+    const BatchEvaluator evaluator(weights);
+    const std::size_t count = data.positions.size();
+    const std::size_t perThread = (count + threads - 1) / threads;
+    std::vector<double> sums(threads, 0.0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        std::size_t begin = std::min(count, t * perThread);
+        std::size_t end = std::min(count, begin + perThread);
+        workers.emplace_back([&, t, begin, end]() {
+            std::vector<int> scores(BATCH);
+            double sum = 0;
+            for (std::size_t i = begin; i < end; i += BATCH) {
+                int n = static_cast<int>(std::min<std::size_t>(BATCH, end - i));
+                evaluator.evaluate(data.positions.data() + i, data.sides.data() + i, n, scores.data());
+                for (int j = 0; j < n; ++j) {
+                    double diff = targets[i + j] - expectedResult(scores[j], k);
+                    sum += diff * diff;
+                }
+            }
+            sums[t] = sum;
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    double total = 0;
+    for (double sum : sums) total += sum;
+    return count ? total / count : 0.0;
+}
+
+/**
+ * @brief Mean squared error between predicted and target results.
+ */
+double meanError(const std::vector<int> &scores, const std::vector<float> &targets, double k) {
+    double sum = 0;
+    for (std::size_t i = 0; i < scores.size(); ++i) {
+        double diff = targets[i] - expectedResult(scores[i], k);
+        sum += diff * diff;
+    }
+    return scores.empty() ? 0.0 : sum / scores.size();
+}
+
+/**
+ * @brief Finds the sigmoid steepness that best fits the scores to the game results.
+ * The error is unimodal in k, so a golden-section search converges.
+ */
+double fitSteepness(const std::vector<int> &scores, const std::vector<float> &results) {
+    double lo = 0.01, hi = 5.0;
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    for (int i = 0; i < 60; ++i) {
+        double a = hi - ratio * (hi - lo);
+        double b = lo + ratio * (hi - lo);
+        if (meanError(scores, results, a) < meanError(scores, results, b)) hi = b;
+        else lo = a;
+    }
+    return (lo + hi) / 2;
+}
+
+/**
+ * @brief Lists every weight worth tuning. The man's value stays at 100, as it sets
+ * the scale every other weight is measured in.
+ */
+std::vector<int *> tunableParameters(EvalWeights &w) {
+    std::vector<int *> params = {&w.kingValue, &w.mobility, &w.tempo};
+    // Men are crowned on row 0 and never stand on it, so those entries do nothing.
+    for (int sq = NUM_SQUARES / 8; sq < NUM_SQUARES; ++sq) {
+        params.push_back(&w.manSquares[sq]);
+    }
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        params.push_back(&w.kingSquares[sq]);
+    }
+    return params;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    RunConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    EvalWeights weights = defaultEvalWeights();
+    if (!config.evalPath.empty() && !loadEvalWeights(config.evalPath, weights)) {
+        std::cerr << "Cannot read evaluation weights " << config.evalPath << "\n";
+        return 1;
+    }
+
+    // Shards are memory-mapped and copied into flat arrays the batch evaluator reads.
+    DataSet data;
+    std::uint64_t total = 0;
+    for (const std::string &path : config.shards) {
+        TrainingShard shard;
+        if (!shard.open(path)) {
+            std::cerr << "Cannot open training shard " << path << "\n";
+            return 1;
+        }
+        total += shard.size();
+        for (std::size_t i = 0; i < shard.size(); ++i) {
+            const TrainingPosition &p = shard.positions()[i];
+            Piece side = p.side == 0 ? TealMan : PurpleMan;
+            if (config.quietOnly && hasCapture(p.bb, side)) continue;
+            data.positions.push_back(p.bb);
+            data.sides.push_back(side);
+            data.results.push_back(p.result / 2.0f);
+            data.searchScores.push_back(p.score);
+        }
+    }
+    std::printf("Positions: %zu used of %llu\n", data.positions.size(), static_cast<unsigned long long>(total));
+    if (data.positions.empty()) {
+        std::cerr << "No positions to tune on\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> scores;
+    evaluateAll(data, weights, config.threads, scores);
+    const double k = fitSteepness(scores, data.results);
+
+    // The target blends the game result with what the search thought of the position.
+    std::vector<float> targets(data.results.size());
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        targets[i] = static_cast<float>(config.lambda * data.results[i] +
+                                        (1 - config.lambda) * expectedResult(data.searchScores[i], k));
+    }
+    double bestError = meanError(scores, targets, k);
+    std::printf("Steepness k = %.4f, initial error %.6f\n", k, bestError);
+
+    // Local search: nudge each weight up or down by the step while the error falls,
+    // halving the step when a whole pass finds nothing.
+    std::vector<int *> params = tunableParameters(weights);
+    int step = 8;
+    for (int pass = 1; pass <= config.passes && step >= 1; ++pass) {
+        int improved = 0;
+        for (int *param : params) {
+            for (int direction : {1, -1}) {
+                *param += direction * step;
+                double error = tuningError(data, weights, targets, k, config.threads);
+                if (error < bestError) {
+                    bestError = error;
+                    ++improved;
+                    break;
+                }
+                *param -= direction * step;
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("Pass %2d: step %d, %3d weights changed, error %.6f (%.1f s)\n", pass, step, improved,
+                    bestError, seconds);
+        if (improved == 0) step /= 2;
+    }
+
+    if (!saveEvalWeights(config.outPath, weights)) {
+        std::cerr << "Cannot write " << config.outPath << "\n";
+        return 1;
+    }
+    std::printf("Wrote tuned weights to %s\n", config.outPath.c_str());
+    return 0;
+}